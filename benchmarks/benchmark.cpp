@@ -0,0 +1,318 @@
+/**
+ * file: benchmark.cpp
+ * synopsis: Throughput benchmarks for MMAS and PSO
+ *           with JSON output
+ * author: Vladyslav Podilnyk
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <functional>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <vector>
+#include "graphGenerator.hpp"
+#include "graphLoader.hpp"
+#include "mmas.hpp"
+#include "pso.hpp"
+
+#ifndef AI_DATA_DIR
+#define AI_DATA_DIR "data"
+#endif
+
+#ifndef AI_BUILD_TYPE
+#define AI_BUILD_TYPE "unknown"
+#endif
+
+using namespace ai::utils;
+
+namespace {
+
+struct Options
+{
+    size_t repetitions = 5;
+    std::string filter;
+    std::string dataDir = AI_DATA_DIR;
+    bool quick = false;
+};
+
+/**
+ * Values of one metric over all repetitions.
+ */
+struct Metric
+{
+    std::string name;
+    std::vector<double> samples;
+};
+
+struct Result
+{
+    std::string name;
+    std::vector<std::pair<std::string, size_t>> parameters;
+    std::vector<Metric> metrics;
+};
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start)
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+/**
+ * A known shortest weight adds the relative excess of the found
+ * route over it as a quality metric. Solves that found no route
+ * only count towards the failures parameter.
+ */
+Result benchmarkMmas(const std::string& name, const ai::Graph& graph,
+                     ai::AntSystemConfig config, const Options& options,
+                     size_t shortestWeight = 0)
+{
+    auto result = Result{name, {{"verticies", graph.size()}, {"edges", graph.edgesCount()},
+                                {"ants", config.numberOfAnts},
+                                {"max_iterations", config.termination.maxIterations}}, {}};
+    auto time = Metric{"real_time_s", {}};
+    auto iterations = Metric{"iterations_per_second", {}};
+    auto antSteps = Metric{"ant_steps_per_second", {}};
+    auto excess = Metric{"excess_over_shortest", {}};
+    auto failures = size_t{0};
+
+    for (size_t repetition = 0; repetition < options.repetitions; ++repetition) {
+        config.seed = 42 + repetition;
+        auto aco = ai::Aco(graph, config);
+
+        auto start = Clock::now();
+        auto route = aco(0, graph.size() - 1);
+        auto seconds = secondsSince(start);
+
+        if (route.empty()) {
+            ++failures;
+        } else if (shortestWeight) {
+            auto weight = graph.getPathWeight(route);
+            excess.samples.push_back(double(weight) / shortestWeight - 1);
+        }
+
+        auto stats = aco.getStats();
+        time.samples.push_back(seconds);
+        iterations.samples.push_back(stats.iterations / seconds);
+        antSteps.samples.push_back(stats.antSteps / seconds);
+    }
+
+    result.parameters.emplace_back("failures", failures);
+    result.metrics = {time, iterations, antSteps};
+    if (shortestWeight) {
+        result.metrics.push_back(excess);
+    }
+    return result;
+}
+
+Result benchmarkPso(const std::string& name, ai::Function<double>& function,
+                    size_t swarmSize, const Options& options)
+{
+    auto dimensions = function.getDimensions();
+    auto budget = options.quick ? 2e5 : 2e6;
+    auto maxIterations = std::clamp<size_t>(static_cast<size_t>(budget / (swarmSize * dimensions)),
+                                            5, 1000);
+
+    auto result = Result{name, {{"dimensions", dimensions}, {"swarm_size", swarmSize},
+                                {"max_iterations", maxIterations}}, {}};
+    auto time = Metric{"real_time_s", {}};
+    auto evaluations = Metric{"evaluations_per_second", {}};
+
+    for (size_t repetition = 0; repetition < options.repetitions; ++repetition) {
+        auto pso = ai::DynamicPso<double>(swarmSize, function, ai::crCoef, ai::sfCoef,
+                                          ai::inrWeight, 42 + repetition);
+
+        auto termination = ai::TerminationPolicy{};
+        termination.maxIterations = maxIterations;
+        pso.setTermination(termination);
+
+        auto start = Clock::now();
+        while (pso.iterate()) {}
+        auto seconds = secondsSince(start);
+
+        time.samples.push_back(seconds);
+        evaluations.samples.push_back(pso.getStats().iterations * swarmSize / seconds);
+    }
+
+    result.metrics = {time, evaluations};
+    return result;
+}
+
+void printStatistics(const std::vector<double>& samples)
+{
+    if (samples.empty()) {
+        std::cout << "null";
+        return;
+    }
+
+    auto sorted = samples;
+    std::sort(begin(sorted), end(sorted));
+
+    auto count = sorted.size();
+    auto mean = std::accumulate(begin(sorted), end(sorted), 0.0) / count;
+    auto median = count % 2 ? sorted[count / 2]
+                            : (sorted[count / 2 - 1] + sorted[count / 2]) / 2;
+    auto variance = 0.0;
+    for (auto sample : sorted) {
+        variance += (sample - mean) * (sample - mean);
+    }
+    auto stddev = count > 1 ? std::sqrt(variance / (count - 1)) : 0.0;
+
+    std::cout << "{\"mean\": " << mean << ", \"median\": " << median
+              << ", \"stddev\": " << stddev << ", \"min\": " << sorted.front()
+              << ", \"max\": " << sorted.back() << "}";
+}
+
+void printJson(const std::vector<Result>& results, const Options& options)
+{
+    auto now = std::time(nullptr);
+    char date[32];
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+    std::cout.precision(6);
+    std::cout << "{\n  \"context\": {\"date\": \"" << date
+              << "\", \"build_type\": \"" << AI_BUILD_TYPE
+#if defined(__AVX512F__)
+              << "\", \"simd\": \"avx512"
+#elif defined(__AVX2__)
+              << "\", \"simd\": \"avx2"
+#else
+              << "\", \"simd\": \"none"
+#endif
+              << "\", \"repetitions\": " << options.repetitions << "},\n"
+              << "  \"benchmarks\": [";
+
+    for (size_t index = 0; index < results.size(); ++index) {
+        const auto& result = results[index];
+        std::cout << (index ? ",\n" : "\n") << "    {\"name\": \"" << result.name << "\"";
+        for (const auto& [key, value] : result.parameters) {
+            std::cout << ", \"" << key << "\": " << value;
+        }
+        for (const auto& metric : result.metrics) {
+            std::cout << ",\n     \"" << metric.name << "\": ";
+            printStatistics(metric.samples);
+        }
+        std::cout << "}";
+    }
+    std::cout << "\n  ]\n}\n";
+}
+
+Options parseOptions(int argc, char** argv)
+{
+    auto options = Options{};
+    for (int index = 1; index < argc; ++index) {
+        auto argument = std::string(argv[index]);
+        auto value = argument.substr(argument.find('=') + 1);
+
+        if (argument.rfind("--repetitions=", 0) == 0) {
+            options.repetitions = std::max<size_t>(std::stoul(value), 1);
+        } else if (argument.rfind("--filter=", 0) == 0) {
+            options.filter = value;
+        } else if (argument.rfind("--data=", 0) == 0) {
+            options.dataDir = value;
+        } else if (argument == "--quick") {
+            options.quick = true;
+        } else {
+            throw std::invalid_argument("Unknown option " + argument + ". Usage: benchmark "
+                                        "[--repetitions=N] [--filter=TEXT] [--data=DIR] [--quick]");
+        }
+    }
+    return options;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    /**
+     * Every benchmark runs with fixed seeds, so two builds
+     * are compared on exactly the same work. Progress goes
+     * to stderr and the report to stdout.
+     */
+    try {
+        auto options = parseOptions(argc, argv);
+
+        auto results = std::vector<Result>();
+        auto run = [&](const std::string& name, const std::function<Result()>& benchmark) {
+            if (name.find(options.filter) == std::string::npos) {
+                return;
+            }
+            std::cerr << "running " << name << "\n";
+            results.push_back(benchmark());
+        };
+
+        for (auto size : {55, 95, 155}) {
+            auto name = "yuzSHP" + std::to_string(size);
+            run("mmas/" + name, [&]() {
+                auto graph = ai::GraphLoader::fromAco(options.dataDir + "/" + name + ".aco");
+                auto config = ai::AntSystemConfig{1.4, 1.4, 10.0, 30, graph.size(), 0.08};
+                config.termination.maxIterations = options.quick ? 50 : 300;
+                return benchmarkMmas("mmas/" + name, graph, config, options);
+            });
+        }
+
+        auto sizes = options.quick ? std::vector<size_t>{1000, 10000}
+                                   : std::vector<size_t>{1000, 10000, 50000};
+        for (auto verticies : sizes) {
+            for (auto degree : {8, 64}) {
+                auto name = "mmas/random/" + std::to_string(verticies) + "x"
+                            + std::to_string(degree);
+                run(name, [&]() {
+                    auto generator = ai::GeneratorConfig{};
+                    generator.verticies = verticies;
+                    generator.density = double(degree) / (verticies - 1);
+                    generator.endPoint = verticies - 1;
+                    generator.pathLength = 16;
+                    generator.seed = verticies + degree;
+                    auto generated = ai::generateGraph(generator);
+
+                    auto config = ai::AntSystemConfig{1.4, 1.4, 10.0, 20, 1000, 0.08};
+                    config.termination.maxIterations = options.quick ? 5 : 20;
+                    return benchmarkMmas(name, generated.graph, config, options,
+                                         generated.pathWeight);
+                });
+            }
+        }
+
+        using Batch = void (*)(PointsView<double>, double*);
+        using Scalar = double (*)(std::valarray<double>&);
+        struct Objective
+        {
+            const char* name;
+            Scalar scalar;
+            Batch batch;
+            std::pair<double, double> limits;
+        };
+        auto objectives = {
+            Objective{"sphere", spherefn<double>, sphereBatch<double>, {-100.0, 100.0}},
+            Objective{"ackley", ackleyfn<double>, ackleyBatch<double>, {-32.768, 32.768}},
+            Objective{"griewank", griewankfn<double>, griewankBatch<double>, {-600.0, 600.0}},
+            Objective{"rastrigin", rastriginfn<double>, rastriginBatch<double>, {-5.12, 5.12}},
+            Objective{"rosenbrok", rosenbrokfn<double>, rosenbrokBatch<double>, {-5.0, 10.0}},
+        };
+
+        for (const auto& objective : objectives) {
+            for (size_t dimensions : {10, 100, 1000}) {
+                for (size_t swarmSize : {32, 256}) {
+                    auto name = std::string("pso/") + objective.name + "/"
+                                + std::to_string(dimensions) + "d/" + std::to_string(swarmSize);
+                    run(name, [&]() {
+                        auto function = ai::Function(objective.scalar, objective.batch,
+                                                     dimensions, objective.limits);
+                        return benchmarkPso(name, function, swarmSize, options);
+                    });
+                }
+            }
+        }
+
+        printJson(results, options);
+    } catch (const std::exception& error) {
+        std::cerr << error.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
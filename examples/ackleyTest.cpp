@@ -9,8 +9,8 @@ int main()
     /**
      * Test for a ackley function.
      */
-    auto ackleyFunction = ai::Function(ackleyfn, 20, std::make_pair(-32.768, 32.768));
-    auto pso = ai::Pso<40>(ackleyFunction, 1.28, 2.4949, 0.72984);
+    auto ackleyFunction = ai::Function(ackleyfn<double>, ackleyBatch<double>, 20, std::make_pair(-32.768, 32.768));
+    auto pso = ai::Pso<40, double>(ackleyFunction, 1.28, 2.4949, 0.72984);
     auto [gMin, gPos] = pso();
     prettyPrint(gMin, gPos, FuncType::Ackley);
 
@@ -0,0 +1,25 @@
+#include <iostream>
+#include "graphLoader.hpp"
+
+int main(int argc, char** argv)
+{
+    /**
+     * Convert a graph from the .aco text format
+     * to the binary .aig format.
+     */
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " <input.aco> <output.aig>\n";
+        return 1;
+    }
+
+    try {
+        auto graph = ai::GraphLoader::fromAco(argv[1], ai::Graph::Storage::Sparse);
+        ai::GraphLoader::toBinary(graph, argv[2]);
+        std::cout << "Wrote " << graph.size() << " verticies and "
+                  << graph.edgesCount() << " edges to " << argv[2] << "\n";
+    } catch (const std::exception& error) {
+        std::cerr << error.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
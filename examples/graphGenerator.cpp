@@ -0,0 +1,129 @@
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include "graphGenerator.hpp"
+#include "graphLoader.hpp"
+
+namespace {
+
+const char* usage =
+    "Usage: graphGenerator [options] (--help prints this)\n"
+    "  --verticies=N          verticies count (1000)\n"
+    "  --density=D            share of vertex pairs joined by an edge (0.01)\n"
+    "  --degree=K             average degree, instead of --density\n"
+    "  --weights=KIND         uniform, normal or exponential (uniform)\n"
+    "  --min-weight=W         smallest drawn weight (1)\n"
+    "  --max-weight=W         largest drawn weight (255)\n"
+    "  --start=S --end=T      query verticies (0 and N - 1)\n"
+    "  --path-length=L        edges of the planted S-T path (8)\n"
+    "  --no-shortest          keep the path for connectivity only\n"
+    "  --seed=X               random seed (1)\n"
+    "  --aco=FILE             write the .aco text format\n"
+    "  --aig=FILE             write the binary .aig format\n";
+
+ai::WeightDistribution parseDistribution(const std::string& name)
+{
+    if (name == "uniform") {
+        return ai::WeightDistribution::Uniform;
+    }
+    if (name == "normal") {
+        return ai::WeightDistribution::Normal;
+    }
+    if (name == "exponential") {
+        return ai::WeightDistribution::Exponential;
+    }
+    throw std::invalid_argument("Unknown weight distribution " + name + ".");
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    /**
+     * Writes a random graph with a planted start-end path
+     * and reports that path, which is the shortest one
+     * unless --no-shortest is given.
+     */
+    auto config = ai::GeneratorConfig{};
+    auto acoFile = std::string();
+    auto aigFile = std::string();
+
+    try {
+        auto degree = 0.0;
+        auto endPoint = std::string();
+        for (int index = 1; index < argc; ++index) {
+            auto argument = std::string(argv[index]);
+            auto value = argument.substr(argument.find('=') + 1);
+            auto is = [&argument](const char* option) { return argument.rfind(option, 0) == 0; };
+
+            if (argument == "--help") {
+                std::cout << usage;
+                return 0;
+            } else if (is("--verticies=")) {
+                config.verticies = std::stoul(value);
+            } else if (is("--density=")) {
+                config.density = std::stod(value);
+            } else if (is("--degree=")) {
+                degree = std::stod(value);
+            } else if (is("--weights=")) {
+                config.distribution = parseDistribution(value);
+            } else if (is("--min-weight=")) {
+                config.minWeight = std::stoul(value);
+            } else if (is("--max-weight=")) {
+                config.maxWeight = std::stoul(value);
+            } else if (is("--start=")) {
+                config.startPoint = std::stoul(value);
+            } else if (is("--end=")) {
+                endPoint = value;
+            } else if (is("--path-length=")) {
+                config.pathLength = std::stoul(value);
+            } else if (argument == "--no-shortest") {
+                config.plantShortestPath = false;
+            } else if (is("--seed=")) {
+                config.seed = std::stoull(value);
+            } else if (is("--aco=")) {
+                acoFile = value;
+            } else if (is("--aig=")) {
+                aigFile = value;
+            } else {
+                std::cerr << "Unknown option " << argument << "\n" << usage;
+                return 1;
+            }
+        }
+
+        config.endPoint = endPoint.empty() ? config.verticies - 1 : std::stoul(endPoint);
+        if (degree > 0 && config.verticies > 1) {
+            config.density = std::min(degree / (config.verticies - 1), 1.0);
+        }
+        if (acoFile.empty() && aigFile.empty()) {
+            std::cerr << "Nothing to write: give --aco and/or --aig\n" << usage;
+            return 1;
+        }
+
+        auto generated = ai::generateGraph(config);
+
+        auto description = std::ostringstream();
+        description << (config.plantShortestPath ? "shortest" : "planted") << " path "
+                    << config.startPoint << " -> " << config.endPoint
+                    << ", weight " << generated.pathWeight << ":\n";
+        for (auto vertex : generated.path) {
+            description << vertex << " ";
+        }
+
+        if (!acoFile.empty()) {
+            ai::GraphLoader::toAco(generated.graph, acoFile, description.str());
+        }
+        if (!aigFile.empty()) {
+            ai::GraphLoader::toBinary(generated.graph, aigFile);
+        }
+
+        std::cout << "Generated " << generated.graph.size() << " verticies and "
+                  << generated.graph.edgesCount() << " edges, "
+                  << description.str() << "\n";
+    } catch (const std::exception& error) {
+        std::cerr << error.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
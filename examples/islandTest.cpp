@@ -0,0 +1,22 @@
+#include <iostream>
+#include "utils.hpp"
+#include "islandPso.hpp"
+
+using namespace ai::utils;
+
+int main()
+{
+    /**
+     * Test for the island model on a rastrigin
+     * function with many dimensions.
+     */
+    auto rastriginFunction = ai::Function(rastriginfn<double>, rastriginBatch<double>, 100, std::make_pair(-5.12, 5.12));
+    auto config = ai::IslandPsoConfig{8, 60, 50, 2, 4, 2.0, 2.0, 0.5};
+    auto pso = ai::IslandPso<double>(rastriginFunction, config);
+    auto [gMin, gPos] = pso();
+    prettyPrint(gMin, gPos, FuncType::Rastrigin);
+
+    std::cout << "Check result of PSO:\n";
+    std::cout << "Res = " << rastriginfn(gPos) << std::endl;
+    return 0;
+}
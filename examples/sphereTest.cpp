@@ -9,8 +9,11 @@ int main()
     /**
      * Test for a sphere function.
      */
-    auto sphereFunction = ai::Function(spherefn, 50, std::make_pair(-100.0, 100.0));
-    auto pso = ai::Pso<60>(sphereFunction, ai::crCoef, ai::sfCoef, 0.42984);
+    auto sphereFunction = ai::Function(spherefn<double>, sphereBatch<double>, 50, std::make_pair(-100.0, 100.0));
+    auto pso = ai::Pso<60, double>(sphereFunction, ai::crCoef, ai::sfCoef, 0.42984);
+    pso.setStatsCallback([](const ai::PsoStats<double>& stats) {
+        std::cout << "Iteration " << stats.iterations << ": best = " << stats.globalBest << "\n";
+    }, 500);
     auto [gMin, gPos] = pso();
     prettyPrint(gMin, gPos, FuncType::Sphere);
 
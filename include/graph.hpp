@@ -0,0 +1,170 @@
+/**
+ * file: graph.hpp
+ * synopsis: Weighted graph used by the ant system algorithms
+ * author: Vladyslav Podilnyk
+ */
+
+#ifndef __AI_GRAPH_HPP__
+#define __AI_GRAPH_HPP__
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <vector>
+#include "utils.hpp"
+
+namespace ai {
+
+/**
+ * Read-only view over edge weights stored in 1, 2, 4 or 8 bytes
+ * each. Elements are widened to size_t on access, so sums of them
+ * are always accumulated in 64 bits.
+ */
+class WeightsView
+{
+    public:
+        WeightsView() = default;
+        WeightsView(const void* data, size_t size, size_t bytes)
+            : first{static_cast<const std::uint8_t*>(data)}, count{size}, width{bytes} {};
+
+        size_t operator[](size_t index) const {
+            switch (width) {
+                case 1: return first[index];
+                case 2: return load<std::uint16_t>(index);
+                case 4: return load<std::uint32_t>(index);
+                default: return load<std::uint64_t>(index);
+            }
+        }
+
+        WeightsView subview(size_t offset, size_t size) const {
+            return {first + offset * width, size, width};
+        }
+
+        const void* data() const { return first; };
+        size_t size() const { return count; };
+        size_t bytes() const { return width; };
+        bool empty() const { return count == 0; };
+
+    private:
+        template <typename Weight>
+        size_t load(size_t index) const {
+            auto value = Weight{};
+            std::memcpy(&value, first + index * sizeof(Weight), sizeof(Weight));
+            return value;
+        }
+
+        const std::uint8_t* first = nullptr;
+        size_t count = 0;
+        size_t width = 8;
+};
+
+/**
+ * Narrowest of 1, 2, 4 and 8 bytes able to hold maxWeight.
+ */
+inline size_t weightBytesFor(size_t maxWeight)
+{
+    if (maxWeight <= 0xff) {
+        return 1;
+    } else if (maxWeight <= 0xffff) {
+        return 2;
+    } else if (maxWeight <= 0xffffffff) {
+        return 4;
+    }
+    return 8;
+}
+
+/**
+ * Graph keeps its edges in compressed sparse row (CSR) form:
+ * neighbours of vertex v are stored in neighbours[offsets[v] .. offsets[v + 1]),
+ * sorted by vertex id, with matching entries in weights. An index into these
+ * arrays is called an edge index and is stable for the lifetime of the graph.
+ *
+ * In Dense mode the full N x N weight matrix is kept as well, so that
+ * getWeight() is a single lookup. Sparse mode drops it and resolves
+ * weights with a binary search over the row, which is what large,
+ * sparse instances need. A zero weight always means "no edge".
+ *
+ * Weights of existing edges can be changed in place with setWeight(),
+ * which keeps edge indices valid; edges are never added or removed.
+ * It changes the one directed edge it is given, so an undirected
+ * graph needs a second call for the reverse edge.
+ *
+ * The CSR arrays may also live outside the graph, e.g. in a memory
+ * mapped file; owner keeps that memory alive and is shared by copies.
+ * setWeight() on such a graph copies the weights first. A Sparse graph
+ * over such arrays only checks its offsets on construction, so that
+ * the rest of the memory is not touched; verify() checks neighbours
+ * and weights as well, as the other constructors always do.
+ *
+ * Weights, in both CSR and dense form, are stored in the narrowest
+ * width that holds the largest of them (see getWeightBytes()), which
+ * cuts the memory of small-weight instances by up to 8 times.
+ * setWeight() widens the storage when a new weight does not fit.
+ */
+class Graph
+{
+    public:
+        enum class Storage {Dense, Sparse};
+
+        Graph() { repoint(); };
+        explicit Graph(const utils::matrix<size_t>& wages, Storage storage = Storage::Dense);
+        Graph(std::vector<size_t> offsets, std::vector<size_t> neighbours,
+              std::vector<size_t> weights, Storage storage = Storage::Sparse);
+        Graph(utils::span<const size_t> offsets, utils::span<const size_t> neighbours,
+              WeightsView weights, std::shared_ptr<const void> owner,
+              Storage storage = Storage::Sparse);
+        Graph(const Graph& other);
+        Graph(Graph&& other) = default;
+        Graph& operator=(const Graph& other);
+        Graph& operator=(Graph&& other) = default;
+
+        size_t getPathWeight(utils::span<const size_t> path) const;
+        size_t getPathWeight(const utils::verticies& path) const {
+            return getPathWeight({path.data(), path.size()});
+        };
+        size_t getWeight(size_t startNode, size_t endNode) const;
+        size_t operator()(size_t startNode, size_t endNode) const;
+        size_t setWeight(size_t startNode, size_t endNode, size_t weight);
+        utils::verticies getAdjacentVerticies(const size_t vertex) const;
+
+        // zero-allocation access to the CSR arrays
+        utils::span<const size_t> getNeighbours(size_t vertex) const;
+        WeightsView getNeighbourWeights(size_t vertex) const;
+        size_t getEdgeOffset(size_t vertex) const { return offsets[vertex]; };
+        std::optional<size_t> findEdge(size_t startNode, size_t endNode) const;
+        size_t edgesCount() const { return neighbours.size(); };
+        size_t getMaxDegree() const;
+
+        Storage getStorage() const { return storage; };
+        size_t getWeightBytes() const { return weightBytes; };
+        size_t size() const { return verticiesCount; };
+        void verify() const;
+        ~Graph() = default;
+
+    private:
+        void repoint();
+        void validateOffsets() const;
+        void buildDense();
+        void packWeights(const std::vector<size_t>& values);
+        void widenWeights(size_t bytes);
+        static void writeWeight(std::uint8_t* destination, size_t bytes, size_t value);
+
+        Storage storage = Storage::Dense;
+        size_t verticiesCount = 0;
+        size_t weightBytes = 1;
+        utils::alignedVector<std::uint8_t> dense;
+
+        // CSR arrays, viewing either the owned vectors or memory kept alive by owner
+        utils::span<const size_t> offsets;
+        utils::span<const size_t> neighbours;
+        WeightsView weights;
+        std::vector<size_t> ownedOffsets = std::vector<size_t>(1);
+        std::vector<size_t> ownedNeighbours;
+        utils::alignedVector<std::uint8_t> ownedWeights;
+        std::shared_ptr<const void> owner;
+};
+
+} // ai
+
+#endif // __AI_GRAPH_HPP__
@@ -0,0 +1,58 @@
+/**
+ * file: graphGenerator.hpp
+ * synopsis: Random graph instances with
+ *           a known shortest path
+ * author: Vladyslav Podilnyk
+ */
+
+#ifndef __AI_GRAPH_GENERATOR_HPP__
+#define __AI_GRAPH_GENERATOR_HPP__
+
+#include <cstdint>
+#include "graph.hpp"
+
+namespace ai {
+
+enum class WeightDistribution {Uniform, Normal, Exponential};
+
+struct GeneratorConfig
+{
+    size_t verticies = 1000;
+    double density = 0.01; // share of all vertex pairs joined by an edge
+    WeightDistribution distribution = WeightDistribution::Uniform;
+    size_t minWeight = 1;
+    size_t maxWeight = 255;
+    size_t startPoint = 0;
+    size_t endPoint = 999;
+    size_t pathLength = 8; // edges of the planted start-end path
+    bool plantShortestPath = true;
+    std::uint64_t seed = 1;
+};
+
+struct GeneratedGraph
+{
+    Graph graph;
+    utils::verticies path;
+    size_t pathWeight;
+};
+
+/**
+ * Random symmetric graph. A path of pathLength edges from startPoint
+ * to endPoint through random verticies is always planted, so the two
+ * are connected; other pairs get an edge with probability density.
+ * Weights are drawn from distribution, limited to [minWeight, maxWeight].
+ *
+ * With plantShortestPath every vertex v gets a potential d(v): the
+ * distance along the planted path for its verticies, a random value
+ * in [0, d(endPoint)] for the rest. Every other edge (u, v) weighs
+ * |d(u) - d(v)| plus a drawn weight, so any path leaving the planted
+ * one is strictly longer and the planted path is the unique shortest.
+ * Weights of those edges may thus exceed maxWeight.
+ *
+ * Invalid settings throw std::invalid_argument.
+ */
+GeneratedGraph generateGraph(const GeneratorConfig& config);
+
+} // ai
+
+#endif // __AI_GRAPH_GENERATOR_HPP__
@@ -0,0 +1,84 @@
+/**
+ * file: graphLoader.hpp
+ * synopsis: Loading graphs from
+ *           .aco and binary files
+ * author: Vladyslav Podilnyk
+ */
+
+#ifndef __AI_GRAPH_LOADER_HPP__
+#define __AI_GRAPH_LOADER_HPP__
+
+#include <cstdint>
+#include <string>
+#include "graph.hpp"
+
+namespace ai {
+
+/**
+ * Binary graph format (.aig), version 1. All numbers are little-endian
+ * and every section starts on a cache line boundary:
+ *
+ *   header      BinaryGraphHeader
+ *   offsets     uint64[verticiesCount + 1]
+ *   neighbours  uint64[edgesCount]
+ *   weights     uint<8 * weightBytes>[edgesCount], weightBytes is 1, 2, 4 or 8
+ *
+ * Section positions are byte offsets from the start of the file.
+ */
+struct BinaryGraphHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t weightBytes;
+    std::uint64_t verticiesCount;
+    std::uint64_t edgesCount;
+    std::uint64_t offsetsSection;
+    std::uint64_t neighboursSection;
+    std::uint64_t weightsSection;
+};
+
+constexpr char binaryGraphMagic[8] = {'A', 'I', 'G', 'R', 'A', 'P', 'H', '\0'};
+constexpr std::uint32_t binaryGraphVersion = 1;
+
+/**
+ * Reads the .aco text format:
+ *
+ *   c <comment>
+ *   p <verticies count>
+ *   i <weight 0> <weight 1> ... <weight N-1>   (one line per row)
+ *
+ * The file is memory mapped and numbers are parsed in place with
+ * std::from_chars. Rows go straight into CSR arrays, dropping zero
+ * weights, so no dense matrix is built unless Dense storage is asked for.
+ *
+ * Malformed input throws std::invalid_argument with a message of
+ * the form "<name>:<line>: <problem>"; a missing file throws
+ * std::ios_base::failure.
+ *
+ * fromBinary() maps an .aig file and hands the mapped arrays to
+ * Graph without copying them; the mapping lives as long as any copy
+ * of the graph, and processes loading the same file share its pages.
+ * Only the header and the offsets are checked unless verify is set,
+ * which reads the whole file once (see Graph::verify()).
+ * toBinary() writes any graph in that format, toAco() in the text
+ * one, with every line of comment as a "c" record before the rows.
+ */
+class GraphLoader
+{
+    public:
+        static Graph fromAco(const std::string& filename,
+                             Graph::Storage storage = Graph::Storage::Dense);
+        static Graph fromAco(const char* first, const char* last, Graph::Storage storage,
+                             const std::string& name = "<memory>");
+
+        static Graph fromBinary(const std::string& filename,
+                                Graph::Storage storage = Graph::Storage::Sparse,
+                                bool verify = false);
+        static void toBinary(const Graph& graph, const std::string& filename);
+        static void toAco(const Graph& graph, const std::string& filename,
+                          const std::string& comment = "");
+};
+
+} // ai
+
+#endif // __AI_GRAPH_LOADER_HPP__
@@ -0,0 +1,88 @@
+/**
+ * file: instrumentation.hpp
+ * synopsis: Phase timers and progress callbacks
+ *           that compile away when disabled
+ * author: Vladyslav Podilnyk
+ */
+
+#ifndef __AI_INSTRUMENTATION_HPP__
+#define __AI_INSTRUMENTATION_HPP__
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+
+#ifndef AI_INSTRUMENTATION
+#define AI_INSTRUMENTATION 1
+#endif
+
+namespace ai::utils {
+
+/**
+ * Built with AI_INSTRUMENTATION set to 0, the optimizers keep only
+ * the counters their stop criteria need: timers read no clock,
+ * optional counters stay zero and stats callbacks are never called.
+ */
+constexpr bool instrumentation = AI_INSTRUMENTATION;
+
+/**
+ * Adds its own lifetime, in seconds, to the given accumulator.
+ */
+class PhaseTimer
+{
+    using Clock = std::chrono::steady_clock;
+
+    public:
+        explicit PhaseTimer(double& seconds) : seconds{seconds} {
+            if constexpr (instrumentation) {
+                start = Clock::now();
+            }
+        }
+        PhaseTimer(const PhaseTimer&) = delete;
+        PhaseTimer& operator=(const PhaseTimer&) = delete;
+        ~PhaseTimer() {
+            if constexpr (instrumentation) {
+                seconds += std::chrono::duration<double>(Clock::now() - start).count();
+            }
+        }
+
+    private:
+        double& seconds;
+        Clock::time_point start;
+};
+
+/**
+ * Passes Stats to the user callback once at least interval
+ * iterations (Stats::iterations) went by since the last call.
+ * The callback runs on the thread driving the optimizer.
+ */
+template <typename Stats>
+class StatsReporter
+{
+    public:
+        using Callback = std::function<void(const Stats&)>;
+
+        void set(Callback callback, size_t interval) {
+            this->callback = std::move(callback);
+            this->interval = std::max<size_t>(interval, 1);
+        }
+        void reset() { reported = 0; };
+
+        void operator()(const Stats& stats) {
+            if constexpr (instrumentation) {
+                if (callback && stats.iterations >= reported + interval) {
+                    reported = stats.iterations;
+                    callback(stats);
+                }
+            }
+        }
+
+    private:
+        Callback callback;
+        size_t interval = 1;
+        size_t reported = 0;
+};
+
+} // utils
+
+#endif // __AI_INSTRUMENTATION_HPP__
@@ -0,0 +1,177 @@
+/**
+ * file: islandPso.hpp
+ * synopsis: Several PSO swarms running in parallel
+ *           and exchanging their best particles
+ * author: Vladyslav Podilnyk
+ */
+
+#ifndef __AI_ISLAND_PSO_HPP__
+#define __AI_ISLAND_PSO_HPP__
+
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <valarray>
+#include <vector>
+#include "pso.hpp"
+#include "threadPool.hpp"
+#include "tripleBuffer.hpp"
+
+namespace ai {
+
+struct IslandPsoConfig
+{
+    size_t islands = 4;
+    size_t swarmSize = 40;
+    size_t migrationInterval = 50; // iterations between migrations
+    size_t migrants = 1; // best particles sent per migration
+    size_t numberOfThreads = 1;
+    double cognitiveForceCoef = crCoef;
+    double socialForceCoef = sfCoef;
+    double inertiaWeight = inrWeight;
+    std::optional<std::uint64_t> seed = std::nullopt;
+    TerminationPolicy termination = TerminationPolicy{}; // applies to every island
+};
+
+/**
+ * Island model PSO: independent swarms, each with its own gBest,
+ * arranged in a ring. Every migrationInterval iterations an island
+ * publishes its best particles and takes in the latest ones published
+ * by its predecessor, where they replace its worst particles.
+ *
+ * Islands are spread over the thread pool and never wait for each
+ * other: every island has an outbox (utils::TripleBuffer) with itself
+ * as the only writer and its successor as the only reader. A thread
+ * serving several islands runs them in turns of migrationInterval
+ * iterations. Each island stops by config.termination, counted from
+ * the start of operator() and over its own iterations and evaluations.
+ *
+ * With one thread the result depends only on the seed; with more,
+ * migrants arrive at timing-dependent iterations. The objective is
+ * called from several threads at once, so it has to be thread-safe.
+ */
+template <typename T = value_t>
+class IslandPso
+{
+    public:
+        IslandPso(Function<T>& f, const IslandPsoConfig& config = IslandPsoConfig{});
+        std::pair<T, std::valarray<T>> operator()();
+        size_t getIslandsCount() const { return swarms.size(); };
+        ~IslandPso() = default;
+
+    private:
+        struct Migrants
+        {
+            size_t count = 0;
+            std::vector<T> fitness;
+            std::vector<T> positions;
+        };
+
+        void runIslands(size_t first, size_t last);
+        void migrate(size_t island);
+
+        IslandPsoConfig config;
+        std::vector<DynamicPso<T>> swarms;
+        std::vector<std::unique_ptr<utils::TripleBuffer<Migrants>>> outboxes;
+        std::shared_ptr<ThreadPool> threadPool;
+};
+
+template <typename T>
+IslandPso<T>::IslandPso(Function<T>& f, const IslandPsoConfig& config)
+    : config{config}
+{
+    if (!config.islands) {
+        throw std::invalid_argument("Island model needs at least one island.");
+    }
+
+    auto seed = config.seed ? *config.seed : rgen::makeSeed();
+    auto migrants = Migrants{};
+    migrants.fitness.resize(config.migrants);
+    migrants.positions.resize(config.migrants * f.getDimensions());
+
+    swarms.reserve(config.islands);
+    for (size_t island = 0; island < config.islands; ++island) {
+        swarms.emplace_back(config.swarmSize, f, config.cognitiveForceCoef,
+                            config.socialForceCoef, config.inertiaWeight,
+                            rgen::splitMix64(seed));
+        outboxes.push_back(std::make_unique<utils::TripleBuffer<Migrants>>(migrants));
+    }
+
+    if (config.numberOfThreads > 1) {
+        threadPool = std::make_shared<ThreadPool>(config.numberOfThreads);
+    }
+}
+
+template <typename T>
+void IslandPso<T>::migrate(size_t island)
+{
+    auto islands = swarms.size();
+    if (islands == 1) {
+        return;
+    }
+
+    auto& outbox = *outboxes[island];
+    auto& outgoing = outbox.back();
+    outgoing.count = swarms[island].emigrate(config.migrants, outgoing.fitness.data(),
+                                             outgoing.positions.data());
+    outbox.publish();
+
+    auto& inbox = *outboxes[(island + islands - 1) % islands];
+    if (inbox.update()) {
+        const auto& incoming = inbox.front();
+        swarms[island].immigrate(incoming.count, incoming.fitness.data(),
+                                 incoming.positions.data());
+    }
+}
+
+template <typename T>
+void IslandPso<T>::runIslands(size_t first, size_t last)
+{
+    auto finished = std::vector<bool>(last - first, false);
+    auto active = last - first;
+    auto interval = std::max<size_t>(config.migrationInterval, 1);
+
+    while (active) {
+        for (auto island = first; island < last; ++island) {
+            if (finished[island - first]) {
+                continue;
+            }
+
+            for (size_t iteration = 0; iteration < interval; ++iteration) {
+                if (!swarms[island].iterate()) {
+                    finished[island - first] = true;
+                    --active;
+                    break;
+                }
+            }
+            migrate(island);
+        }
+    }
+}
+
+template <typename T>
+std::pair<T, std::valarray<T>> IslandPso<T>::operator()()
+{
+    for (auto& swarm : swarms) {
+        swarm.setTermination(config.termination);
+    }
+
+    auto task = [this](size_t first, size_t last, size_t) { runIslands(first, last); };
+    if (threadPool) {
+        threadPool->parallelFor(swarms.size(), task);
+    } else {
+        task(0, swarms.size(), 0);
+    }
+
+    auto best = std::min_element(begin(swarms), end(swarms), [](auto& lhs, auto& rhs) {
+        return lhs.getGlobalBest() < rhs.getGlobalBest();
+    });
+
+    auto position = best->getGlobalBestPosition();
+    return std::make_pair(best->getGlobalBest(),
+                          std::valarray<T>(position, best->getDimensions()));
+}
+
+} // ai
+
+#endif // __AI_ISLAND_PSO_HPP__
@@ -0,0 +1,88 @@
+/**
+ * file: mappedFile.hpp
+ * synopsis: Read-only memory mapping
+ *           of a whole file.
+ * author: Vladyslav Podilnyk
+ */
+
+#ifndef __AI_MAPPED_FILE_HPP__
+#define __AI_MAPPED_FILE_HPP__
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <ios>
+#include <string>
+#include <utility>
+
+namespace ai::utils {
+
+/**
+ * Maps a file read-only for its whole lifetime. The pages are
+ * loaded by the kernel on first touch, so parsing reads straight
+ * from the page cache without copying into a stream buffer.
+ * An empty file maps to an empty range.
+ */
+class MappedFile
+{
+    public:
+        explicit MappedFile(const std::string& filename);
+        MappedFile(MappedFile&& other) noexcept { swap(other); };
+        MappedFile& operator=(MappedFile&& other) noexcept { swap(other); return *this; };
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        const char* data() const { return static_cast<const char*>(address); };
+        size_t size() const { return length; };
+        ~MappedFile();
+
+    private:
+        void swap(MappedFile& other) noexcept {
+            std::swap(address, other.address);
+            std::swap(length, other.length);
+        }
+
+        void* address = nullptr;
+        size_t length = 0;
+};
+
+inline MappedFile::MappedFile(const std::string& filename)
+{
+    auto descriptor = ::open(filename.c_str(), O_RDONLY);
+    if (descriptor < 0) {
+        throw std::ios_base::failure("No file with given name: " + filename);
+    }
+
+    struct stat status;
+    if (::fstat(descriptor, &status) != 0) {
+        ::close(descriptor);
+        throw std::ios_base::failure("Can not stat file: " + filename);
+    }
+
+    length = static_cast<size_t>(status.st_size);
+    if (length) {
+        address = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        if (address == MAP_FAILED) {
+            address = nullptr;
+            length = 0;
+            ::close(descriptor);
+            throw std::ios_base::failure("Can not map file: " + filename);
+        }
+        ::madvise(address, length, MADV_SEQUENTIAL);
+    }
+
+    // the mapping stays valid after the descriptor is closed
+    ::close(descriptor);
+}
+
+inline MappedFile::~MappedFile()
+{
+    if (address) {
+        ::munmap(address, length);
+    }
+}
+
+} // utils
+
+#endif // __AI_MAPPED_FILE_HPP__
@@ -10,25 +10,24 @@
 #include <algorithm>
 #include <utility>
 #include <optional>
+#include <limits>
+#include <memory>
+#include "graph.hpp"
+#include "instrumentation.hpp"
+#include "randGen.hpp"
+#include "solveHandle.hpp"
+#include "termination.hpp"
+#include "threadPool.hpp"
 #include "utils.hpp"
 
 namespace ai {
 
-class Graph
-{
-    public:
-        Graph() = default;
-        explicit Graph(const utils::matrix<size_t>& wages) { paths = wages; };
-        size_t getPathWeight(const utils::verticies& path);
-        size_t getWeight(size_t startNode, size_t endNode);
-        size_t operator()(size_t startNode, size_t endNode);
-        utils::verticies getAdjacentVerticies(const size_t vertex);
-        size_t size() { return paths.size(); };
-        size_t size() const { return paths.size(); };
-        ~Graph() = default;
-    private:
-        utils::matrix<size_t> paths;
-};
+/**
+ * Who receives whose best route in the island model: in a Ring
+ * island i gets the best of island i - 1, when FullyConnected
+ * every island gets the best of all of them.
+ */
+enum class IslandTopology {Ring, FullyConnected};
 
 struct AntSystemConfig
 {
@@ -38,49 +37,239 @@ struct AntSystemConfig
     size_t numberOfAnts = 20;
     size_t maxAntMoves = 25;
     double p = 0.08;
+    size_t numberOfThreads = 1;
+    std::optional<std::uint64_t> seed = std::nullopt;
+    size_t candidateListSize = 0; // 0 disables candidate lists
+    size_t warmStartIterations = 100; // stagnation window of reoptimize()
+    size_t islands = 1; // more than 1 enables the island model
+    size_t exchangeInterval = 25; // iterations between island exchanges
+    IslandTopology topology = IslandTopology::Ring;
+    double pheromoneBlend = 0.0; // share of the neighbours' pheromones mixed in on exchange
+    TerminationPolicy termination = TerminationPolicy{}; // per query, also in batches
 };
 
+/**
+ * Work done by the last single query, see Aco::getStats(). Dead-end
+ * ants (stuck with every neighbour visited) and the phase times are
+ * only collected with instrumentation enabled (see instrumentation.hpp).
+ */
+struct SolveStats
+{
+    size_t iterations = 0;
+    size_t antSteps = 0;
+    size_t deadEndAnts = 0;
+    size_t bestPathWeight = std::numeric_limits<size_t>::max(); // max while no route is found
+    double constructSeconds = 0.0;
+    double pheromoneUpdateSeconds = 0.0;
+    double evaporateSeconds = 0.0;
+    double choiceInfoSeconds = 0.0;
+    StopReason stopReason = StopReason::None;
+};
+
+/**
+ * Best route found so far by an asynchronous solve, see Aco::solveAsync().
+ */
+struct RouteSnapshot
+{
+    utils::verticies path;
+    size_t weight = 0;
+    size_t iterations = 0;
+};
+
+/**
+ * Flat list of routes: route i is verticies[offsets[i] .. offsets[i + 1])
+ * and weighs weights[i]. edges run parallel to verticies: the entry
+ * next to a vertex is the CSR index of the edge leaving it along the
+ * route (the last vertex has none). Ants record both as they walk,
+ * so neither weights nor edges are looked up in the graph again.
+ * clear() keeps the capacity, so refilling it every iteration
+ * stops allocating once the buffers have grown.
+ */
+struct Routes
+{
+    void clear() { verticies.clear(); edges.clear(); offsets.resize(1); weights.clear(); };
+    void push(utils::span<const size_t> route, utils::span<const size_t> routeEdges,
+              size_t weight) {
+        verticies.insert(end(verticies), route.begin(), route.end());
+        edges.insert(end(edges), routeEdges.begin(), routeEdges.end());
+        offsets.push_back(verticies.size());
+        weights.push_back(weight);
+    }
+    void append(const Routes& other) {
+        for (size_t index = 0; index < other.size(); ++index) {
+            push(other[index], other.edgesOf(index), other.weights[index]);
+        }
+    }
+
+    size_t size() const { return offsets.size() - 1; };
+    bool empty() const { return offsets.size() == 1; };
+    utils::span<const size_t> operator[](size_t index) const {
+        return {verticies.data() + offsets[index], offsets[index + 1] - offsets[index]};
+    }
+    utils::span<const size_t> edgesOf(size_t index) const {
+        return {edges.data() + offsets[index], offsets[index + 1] - offsets[index]};
+    }
+
+    utils::verticies verticies;
+    std::vector<size_t> edges;
+    std::vector<size_t> offsets = std::vector<size_t>(1);
+    std::vector<size_t> weights;
+};
+
+/**
+ * Aco keeps everything derived from the graph alone (heuristic,
+ * reverse edges, candidate lists) and the thread pool, and shares
+ * them between queries. Each query gets a fresh Colony, so results
+ * never depend on the queries solved before.
+ *
+ * A single query spreads its ants over the pool. A batch runs whole
+ * queries concurrently instead, one colony per pool thread, with
+ * per-query seeds so results do not depend on the thread count.
+ *
+ * With config.islands > 1 a single query runs that many independent
+ * colonies instead, one per pool thread at a time. Every
+ * exchangeInterval iterations they stop, receive the best route of
+ * their neighbours (see IslandTopology) and optionally blend in their
+ * pheromones. Batches always use one colony per query.
+ *
+ * A graph in which every edge has a reverse edge of the same weight
+ * is undirected: ants deposit on both directions of an edge and
+ * updateWeight() changes both. Any other graph is directed.
+ *
+ * After aco(s, t), updateWeight() may change edge weights in place;
+ * reoptimize() then resumes that query from its current pheromones
+ * and best path instead of starting cold.
+ *
+ * Every query stops by config.termination and returns the best route
+ * found so far; its limits count from the start of that query. The
+ * island model checks them between exchanges and, inside an epoch,
+ * only the time limit.
+ *
+ * setStatsCallback() reports the progress of single queries and of
+ * reoptimize(); the island model reports after exchanges, summing
+ * the work of all islands. Batches report nothing.
+ *
+ * solveAsync() runs aco(s, t) on a background thread and publishes
+ * every improvement of the best route to the returned handle. The
+ * Aco must outlive the handle and must not be used until the solve
+ * has finished.
+ */
 class Aco
 {
     public:
+        using Query = std::pair<size_t, size_t>;
+
         Aco() = default;
         Aco(const Graph& graph, const AntSystemConfig& config = AntSystemConfig{});
         utils::verticies operator()(size_t startPoint, size_t endPoint);
+        std::vector<utils::verticies> operator()(const std::vector<Query>& queries);
+        SolveHandle<RouteSnapshot, utils::verticies> solveAsync(size_t startPoint,
+                                                                size_t endPoint);
+
+        // incremental re-optimization of the last single query
+        void updateWeight(size_t startNode, size_t endNode, size_t weight);
+        utils::verticies reoptimize();
+        const Graph& getGraph() const { return graph; };
+        SolveStats getStats() const { return colony.stats; };
+        void setStatsCallback(std::function<void(const SolveStats&)> callback,
+                              size_t interval = 1);
         ~Aco() = default;
 
     private:
+        /**
+         * State owned by one construction worker. Ants handled by
+         * the same worker share its random engine and buffers, all
+         * sized up front, so a walk does not allocate.
+         *
+         * visited[v] == epoch marks v as visited by the current ant;
+         * bumping epoch forgets the previous walk in O(1).
+         * candidates hold positions within the current CSR row.
+         */
+        struct AntWorker
+        {
+            rgen::RandGen<> engine;
+            utils::verticies route;
+            std::vector<size_t> routeEdges; // parallel to route, see Routes
+            size_t routeWeight = 0;
+            size_t steps = 0;
+            size_t deadEnds = 0;
+            std::vector<std::uint32_t> visited;
+            std::uint32_t epoch = 0;
+            utils::verticies candidates;
+            std::vector<double> probabilities;
+            Routes finishedRoutes;
+        };
+
+        /**
+         * Mutable state of one query. Buffers are kept between
+         * queries and only refilled by resetColony().
+         */
+        struct Colony
+        {
+            size_t startPoint = 0;
+            size_t endPoint = 0;
+            utils::alignedVector<double> pheromones;
+            std::vector<double> choiceInfo;
+            utils::verticies shortestPath;
+            std::vector<size_t> shortestEdges; // parallel to shortestPath, see Routes
+            size_t bestPathWeight = 0;
+            double maxPheromoneLevel = 0.0;
+            double minPheromoneLevel = 0.0;
+            Termination termination;
+            SolveStats stats;
+            std::vector<AntWorker> antWorkers;
+            Routes solutions;
+        };
+
         // functions
 
         // steps of the algorithm
-        utils::matrix<size_t> constructSolutions();
-        void updatePheromoneLevel(utils::matrix<size_t>& routes);
-        void evaporate();
+        const Routes& constructSolutions(Colony& colony, ThreadPool* pool);
+        void updatePheromoneLevel(Colony& colony, const Routes& routes);
+        void evaporate(Colony& colony);
+        void updateChoiceInfo(Colony& colony, ThreadPool* pool);
+        void iterate(Colony& colony, ThreadPool* pool);
+        utils::verticies solve(Colony& colony, ThreadPool* pool, bool report = true);
+        utils::verticies solveIslands(const Query& query);
+        void exchangeBestRoutes();
+        void blendPheromones();
 
         // helpers
-        bool isRouteCompleted(const utils::verticies& route);
-        std::optional<size_t> getNextVertex(const utils::verticies& route);
-        std::vector<double> calculateProbabilities(const size_t vertex,
-                                            utils::verticies& adjacentVerticies);
-        std::pair<size_t, utils::verticies> findBest(const utils::matrix<size_t>& routes);
-        double getMaxPheromoneLevel();
-        double getMinPheromoneLevel();
-        double getPheromone(size_t startPoint, size_t endPoint);
-        void setPheromone(size_t startPoint, size_t endPoint, double value);
-        utils::verticies filterVisitedVerticies(const utils::verticies& route,
-                                        const utils::verticies& adjacentVerticies);
-        bool isFinished();
+        void resetColony(Colony& colony, const Query& query, size_t workers,
+                         std::uint64_t seed);
+        bool isRouteCompleted(const Colony& colony, const utils::verticies& route);
+        void walkAnt(Colony& colony, AntWorker& worker);
+        void startWalk(Colony& colony, AntWorker& worker);
+        void buildCandidateLists();
+        void sortCandidates(size_t vertex, size_t* candidates);
+        std::optional<size_t> getNextEdge(const Colony& colony, AntWorker& worker);
+        std::pair<size_t, size_t> findBest(const Routes& routes);
+        void updatePheromoneLimits(Colony& colony);
+        bool isFinished(Colony& colony);
+        bool isCancelled() const { return channel && channel->isCancelled(); };
+        void publishBest(const Colony& colony);
 
         //data
         Graph graph;
         AntSystemConfig config;
-        utils::matrix<double> pheromones;
-        utils::verticies shortestPath;
-        size_t bestPathWeight;
-        size_t startPoint;
-        size_t endPoint;
-        size_t countDown;
+        bool undirected = true;
+        std::vector<size_t> reverseEdges; // empty unless undirected
+        std::vector<double> heuristic;
+        std::vector<size_t> candidateLists;
+        std::vector<size_t> candidateOffsets;
+        std::uint64_t seed;
+        Colony colony;
+        std::vector<Colony> batchColonies;
+        std::vector<Colony> islandColonies;
+        Routes migrants;
+        Routes incoming;
+        utils::alignedVector<double> blendBuffer;
+        utils::StatsReporter<SolveStats> reportStats;
+        std::shared_ptr<SolveChannel<RouteSnapshot>> channel;
+        size_t publishedWeight = 0;
+        std::shared_ptr<ThreadPool> threadPool;
         static constexpr double Q = 100;
-        static constexpr size_t iterationsBeforeComplete = 1000;
+        static constexpr size_t noEdge = std::numeric_limits<size_t>::max();
 };
 
 } // ai
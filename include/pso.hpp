@@ -8,20 +8,40 @@
 #define __AI_PSO_HPP__
 
 #include <cmath>
-#include <array>
 #include <algorithm>
 #include <functional>
 #include <limits>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
 #include <valarray>
 
+#include <memory>
+
 #include "utils.hpp"
+#include "instrumentation.hpp"
 #include "randGen.hpp"
+#include "psoKernels.hpp"
+#include "solveHandle.hpp"
+#include "termination.hpp"
+#include "threadPool.hpp"
 
-#define PRINT_BEST 1
+/**
+ * Compile-time switches, each may be overridden with -D<NAME>=1.
+ * Progress is reported through DynamicPso::setStatsCallback().
+ */
+#ifndef RETURN_TO_BOUND
 #define RETURN_TO_BOUND 0
+#endif
+#ifndef CLAMP_VELOCITY
 #define CLAMP_VELOCITY 0
+#endif
+#ifndef DYNAMIC_INERTIA_WEIGHT
 #define DYNAMIC_INERTIA_WEIGHT 0 // poor implementation, DO NOT USE THIS
+#endif
+#ifndef CALCULATE_AVERAGE_VELOCITY
 #define CALCULATE_AVERAGE_VELOCITY 0 // stop criteria
+#endif
 
 using ai::utils::value_t;
 using ai::utils::print; // for Debug purposes
@@ -40,330 +60,651 @@ constexpr auto inrWeightMax = 0.92984;
 constexpr auto inrWeightMin = 0.42984;
 constexpr auto inrWeight = 0.72984;
 constexpr auto eps = value_t {1e-160};
-constexpr auto lastIterNumber = size_t{1000};
+constexpr auto lastIterNumber = size_t{1000}; // iterations of the inertia weight schedule
 
-struct Particle
+/**
+ * Structure-of-arrays storage for the whole swarm. Row i of
+ * positions, velocities and personalBestPos belongs to particle i.
+ * Rows are padded to a whole cache line, so every row starts aligned
+ * and the update kernels never touch a neighbour's data.
+ */
+template <typename T>
+struct SwarmStorage
 {
-    std::valarray<value_t> currentPosition;
-    std::valarray<value_t> velocity;
-    std::valarray<value_t> personalBestPos;
-    value_t personalBest;
+    void resize(size_t particlesCount, size_t dimensionsCount) {
+        constexpr auto lineElements = utils::cacheLineSize / sizeof(T);
+        particles = particlesCount;
+        dimensions = dimensionsCount;
+        stride = (dimensions + lineElements - 1) / lineElements * lineElements;
+        positions.assign(particles * stride, T{0});
+        velocities.assign(particles * stride, T{0});
+        personalBestPos.assign(particles * stride, T{0});
+        personalBest.assign(particles, std::numeric_limits<T>::max());
+#if CALCULATE_AVERAGE_VELOCITY
+        averageVelocity.assign(particles, T{0});
+#endif
+    }
+
+    T* position(size_t particle) { return positions.data() + particle * stride; };
+    T* velocity(size_t particle) { return velocities.data() + particle * stride; };
+    T* bestPosition(size_t particle) { return personalBestPos.data() + particle * stride; };
+
+    size_t particles = 0;
+    size_t dimensions = 0;
+    size_t stride = 0;
+    utils::alignedVector<T> positions;
+    utils::alignedVector<T> velocities;
+    utils::alignedVector<T> personalBestPos;
+    std::vector<T> personalBest;
 
 #if CALCULATE_AVERAGE_VELOCITY
-    value_t averageVelocity;
+    std::vector<T> averageVelocity;
 #endif
 };
 
+/**
+ * Objective function for pso. Besides the per-point function it
+ * may carry a batch version that evaluates a whole block of points
+ * in one call (see utils::PointsView); without one, the batch call
+ * falls back to evaluating points one by one, copying each into
+ * the caller's scratch arguments, so it does not allocate once
+ * scratch has the right size.
+ */
+template <typename T = value_t>
 class Function
 {
-    using FuncArguments = std::valarray<value_t>;
-    using FuncType = std::function<value_t(FuncArguments&)>;
+    using FuncArguments = std::valarray<T>;
+    using FuncType = std::function<T(FuncArguments&)>;
+    using BatchType = std::function<void(utils::PointsView<T>, T*)>;
     using FuncLimits = std::pair<double, double>;
 
     public:
         Function() = default;
         explicit Function(FuncType fn, size_t dim, FuncLimits funcLimits)
             : func{fn}, dimensions{dim}, limits{funcLimits} {};
+        explicit Function(FuncType fn, BatchType batchFn, size_t dim, FuncLimits funcLimits)
+            : func{fn}, batch{batchFn}, dimensions{dim}, limits{funcLimits} {};
 
-        value_t operator()(FuncArguments& args) { return func(args); };
+        T operator()(FuncArguments& args) { return func(args); };
+        void operator()(utils::PointsView<T> points, T* results, FuncArguments& scratch);
         FuncLimits getFuncLimits() { return limits; };
         size_t getDimensions() { return dimensions; };
+        bool hasBatch() { return static_cast<bool>(batch); };
         ~Function() = default;
 
     private:
         FuncType func;
+        BatchType batch;
         size_t dimensions;
         FuncLimits limits;
 };
 
-template <size_t swarmSize>
-class Pso
+template <typename T>
+Function(T (*)(std::valarray<T>&), size_t, std::pair<double, double>) -> Function<T>;
+
+template <typename T>
+Function(T (*)(std::valarray<T>&), void (*)(utils::PointsView<T>, T*),
+         size_t, std::pair<double, double>) -> Function<T>;
+
+template <typename T>
+void Function<T>::operator()(utils::PointsView<T> points, T* results, FuncArguments& scratch)
+{
+    if (batch) {
+        batch(points, results);
+        return;
+    }
+
+    if (scratch.size() != points.dimensions) {
+        scratch.resize(points.dimensions);
+    }
+    for (size_t point = 0; point < points.count; ++point) {
+        std::copy(points[point], points[point] + points.dimensions, begin(scratch));
+        results[point] = func(scratch);
+    }
+}
+
+/**
+ * Progress of a swarm, see DynamicPso::getStats(). Evaluations include
+ * the initial one of every particle. Phase times are only collected
+ * with instrumentation enabled (see instrumentation.hpp).
+ */
+template <typename T>
+struct PsoStats
+{
+    size_t iterations = 0;
+    size_t evaluations = 0;
+    T globalBest = std::numeric_limits<T>::max();
+    double velocityUpdateSeconds = 0.0;
+    double evaluationSeconds = 0.0;
+    double reductionSeconds = 0.0;
+    StopReason stopReason = StopReason::None;
+};
+
+/**
+ * Best point found so far by an asynchronous solve, see
+ * DynamicPso::solveAsync().
+ */
+template <typename T>
+struct PsoSnapshot
+{
+    T value = std::numeric_limits<T>::max();
+    std::vector<T> position;
+    size_t iterations = 0;
+};
+
+/**
+ * PSO with the swarm size chosen at run time. All swarm storage
+ * is allocated once in the constructor; iterations never allocate.
+ *
+ * The swarm stops by its TerminationPolicy (see setTermination()),
+ * which by default waits for 1000 iterations without a new gBest.
+ * Its limits count from the construction of the swarm, the last
+ * setTermination() or the start of operator(), whichever is latest.
+ *
+ * solveAsync() runs operator() on a background thread and publishes
+ * every new gBest to the returned handle. The swarm and the function
+ * must outlive the handle, and the swarm must not be used until the
+ * solve has finished.
+ */
+template <typename T = value_t>
+class DynamicPso
 {
     public:
-        Pso() = default;
-#if CALCULATE_AVERAGE_VELOCITY
-        Pso(Function& f, double cognitiveForceCoef, double socialForceCoef,
-            double inertiaWeight, value_t eps);
-        Pso(Function& f) : Pso(f, crCoef, sfCoef, inrWeight, eps) {};
-#else
-        Pso(Function& f, double cognitiveForceCoef, double socialForceCoef,
-            double inertiaWeight);
-        Pso(Function& f) : Pso(f, crCoef, sfCoef, inrWeight) {};
-#endif
-        std::pair<value_t, std::valarray<value_t>> operator()();
-        ~Pso() = default;
+        DynamicPso() = default;
+        // eps is the velocity threshold of CALCULATE_AVERAGE_VELOCITY, ignored otherwise
+        DynamicPso(size_t swarmSize, Function<T>& f, double cognitiveForceCoef,
+                   double socialForceCoef, double inertiaWeight,
+                   std::optional<std::uint64_t> seed = std::nullopt, T eps = ai::eps);
+        DynamicPso(size_t swarmSize, Function<T>& f)
+            : DynamicPso(swarmSize, f, crCoef, sfCoef, inrWeight) {};
+        std::pair<T, std::valarray<T>> operator()();
+        SolveHandle<PsoSnapshot<T>, std::pair<T, std::valarray<T>>> solveAsync();
+        bool iterate();
+        void setThreadPool(std::shared_ptr<ThreadPool> pool);
+        void setTermination(const TerminationPolicy& policy);
+        size_t getSwarmSize() const { return swarm.particles; };
+        size_t getDimensions() const { return swarm.dimensions; };
+        T getGlobalBest() const { return gBest; };
+        const T* getGlobalBestPosition() const { return gBestPos.data(); };
+        const PsoStats<T>& getStats() const { return stats; };
+        void setStatsCallback(std::function<void(const PsoStats<T>&)> callback,
+                              size_t interval = 1) {
+            reportStats.set(std::move(callback), interval);
+        }
+
+        // migration between swarms, positions are packed count x dimensions
+        size_t emigrate(size_t count, T* fitness, T* positions);
+        void immigrate(size_t count, const T* fitness, const T* positions);
+        ~DynamicPso() = default;
 
     private:
         // functions
         inline void initParticlePos();
-        inline void initVelocity();
-        inline void updatePosition(Particle& particle);
-        inline void updateVelocity(Particle& particle);
+        inline void updateParticle(size_t particle, T weight, size_t worker);
+        inline void evaluateSwarm(size_t first, size_t last, size_t worker);
+        inline void forEachParticle(const ThreadPool::Task& task);
         inline void updatePersonalBest();
         inline void updateGlobalBest();
-        void clampVelocities(Particle& particle);
-        void retParticleToBound(Particle& particle);
-        void updateParticle();
+        void retParticleToBound(size_t particle);
+        void updateSwarm();
         void convergenceStep();
-        bool isConverged();
+        bool isFinished();
+        void publishBest();
 
         // data
-        using Swarm = std::array<Particle, swarmSize>;
-        Swarm swarmColony;
-        Function fn;
-        value_t gBest;
-        value_t maxVelocity;
-        std::valarray<value_t> gBestPos;
+        SwarmStorage<T> swarm;
+        Function<T> fn;
+        rgen::RandGen<> engine;
+        std::vector<rgen::RandGen<>> particleEngines;
+        std::shared_ptr<ThreadPool> threadPool;
+        T gBest;
+        T maxVelocity;
+        utils::alignedVector<T> gBestPos;
+        utils::alignedVector<T> rfirst;
+        utils::alignedVector<T> rsecond;
+        std::vector<std::valarray<T>> arguments; // per worker, for objectives without a batch
+        std::vector<T> fitness;
+        std::vector<size_t> migrationOrder;
+        PsoStats<T> stats;
+        utils::StatsReporter<PsoStats<T>> reportStats;
+        std::shared_ptr<SolveChannel<PsoSnapshot<T>>> channel;
+        T publishedBest = std::numeric_limits<T>::max();
         double cognitiveForceCoef;
         double socialForceCoef;
         double inertiaWeight;
-        value_t eps;
-        size_t stopCounter = lastIterNumber;
+        T eps;
+        Termination termination;
         size_t step; // for dynamic calculation of inertia weight
+#if CALCULATE_AVERAGE_VELOCITY
+        size_t stopCounter = 0;
         bool isStuckOrConverged = false;
-        bool maybeStuck = false;
+#endif
 };
 
-template <size_t swarmSize>
-void Pso<swarmSize>::initParticlePos()
+template <typename T>
+void DynamicPso<T>::initParticlePos()
 {
-    auto randNumberGen = rgen::RandGen<>(fn.getFuncLimits());
-    auto dimensions = fn.getDimensions();
-    for (auto& particle : swarmColony) {
-        particle.currentPosition = randNumberGen.generate(dimensions);
-        particle.personalBestPos = particle.currentPosition;
-        particle.personalBest = fn(particle.personalBestPos);
+    auto limits = fn.getFuncLimits();
+    auto dist = std::uniform_real_distribution<T>(limits.first, limits.second);
+
+    for (size_t particle = 0; particle < swarm.particles; ++particle) {
+        auto position = swarm.position(particle);
+        std::generate(position, position + swarm.dimensions, [&]() { return dist(engine); });
+        std::copy(position, position + swarm.dimensions, swarm.bestPosition(particle));
     }
-}
 
-template <size_t swarmSize>
-void Pso<swarmSize>::initVelocity()
-{
-    auto dimensions = fn.getDimensions();
-    for (auto& particle : swarmColony) {
-        particle.velocity.resize(dimensions);
-        std::fill(begin(particle.velocity), end(particle.velocity), 0);
-#if CALCULATE_AVERAGE_VELOCITY
-        particle.averageVelocity = 0;
-#endif
+    evaluateSwarm(0, swarm.particles, 0);
+    swarm.personalBest = fitness;
+
+    for (auto& particleEngine : particleEngines) {
+        particleEngine = rgen::RandGen<>(engine());
     }
 }
 
-template <size_t swarmSize>
-void Pso<swarmSize>::retParticleToBound(Particle& particle)
+template <typename T>
+void DynamicPso<T>::evaluateSwarm(size_t first, size_t last, size_t worker)
 {
-    for (auto& value : particle.currentPosition) {
-        if (value > fn.getFuncLimits().second) {
-            value = fn.getFuncLimits().second / 2;
+    auto points = utils::PointsView<T>{swarm.position(first), last - first,
+                                       swarm.dimensions, swarm.stride};
+    fn(points, fitness.data() + first, arguments[worker]);
+}
 
-        } else if (value < fn.getFuncLimits().first) {
-            value = fn.getFuncLimits().first / 2;
-        }
+/**
+ * Runs task over all particles, split across the thread pool
+ * when one is set. Every particle draws from its own engine,
+ * so the result does not depend on the number of threads.
+ */
+template <typename T>
+void DynamicPso<T>::forEachParticle(const ThreadPool::Task& task)
+{
+    if (threadPool) {
+        threadPool->parallelFor(swarm.particles, task);
+    } else {
+        task(0, swarm.particles, 0);
     }
 }
 
-template <size_t swarmSize>
-void Pso<swarmSize>::updatePosition(Particle& particle)
+/**
+ * The objective function is called concurrently from
+ * all threads of the pool, so it has to be thread-safe.
+ */
+template <typename T>
+void DynamicPso<T>::setThreadPool(std::shared_ptr<ThreadPool> pool)
 {
-    particle.currentPosition += particle.velocity;
-#if RETURN_TO_BOUND
-    retParticleToBound(particle);
-#endif
+    threadPool = std::move(pool);
+    auto workers = threadPool ? threadPool->size() : 1;
+    rfirst.assign(workers * swarm.stride, T{0});
+    rsecond.assign(workers * swarm.stride, T{0});
+    arguments.assign(workers, std::valarray<T>(swarm.dimensions));
 }
 
-template <size_t swarmSize>
-void Pso<swarmSize>::clampVelocities(Particle& particle)
+template <typename T>
+void DynamicPso<T>::retParticleToBound(size_t particle)
 {
-    for (auto& value : particle.velocity) {
-        if (value > maxVelocity) {
-            value = maxVelocity;
+    auto position = swarm.position(particle);
+    for (auto value = position; value != position + swarm.dimensions; ++value) {
+        if (*value > fn.getFuncLimits().second) {
+            *value = fn.getFuncLimits().second / 2;
+
+        } else if (*value < fn.getFuncLimits().first) {
+            *value = fn.getFuncLimits().first / 2;
         }
     }
 }
 
-template <size_t swarmSize>
-void Pso<swarmSize>::updateVelocity(Particle& particle)
+/**
+ * Random factors are drawn into reusable buffers first,
+ * then the kernel updates velocity and position in a single
+ * pass without any temporary arrays.
+ */
+template <typename T>
+void DynamicPso<T>::updateParticle(size_t particle, T weight, size_t worker)
 {
-    auto randGen = rgen::RandGen<>(std::make_pair(0.0, 1.0));
-    auto rfirst = randGen.generate(particle.velocity.size());
-    auto rsecond = randGen.generate(particle.velocity.size());
-
-    std::valarray<value_t> cognitiveForce =
-        rfirst * (particle.personalBestPos - particle.currentPosition);
-    cognitiveForce *= cognitiveForceCoef;
-
-    std::valarray<value_t> socialForce =
-        rsecond * (gBestPos - particle.currentPosition);
-    socialForce *= socialForceCoef;
+    auto& particleEngine = particleEngines[particle];
+    auto first = rfirst.data() + worker * swarm.stride;
+    auto second = rsecond.data() + worker * swarm.stride;
+    for (size_t index = 0; index < swarm.dimensions; ++index) {
+        first[index] = particleEngine.canonical();
+        second[index] = particleEngine.canonical();
+    }
 
-    /**
-     * TODO: Implement calculation for inertia weight
-     *       which should decrease from 0.9 to 0.4.
-     *       Current implementation is bad. DO NOT USE IT !!!.
-     */
-#if DYNAMIC_INERTIA_WEIGHT
-    particle.velocity *= inrWeightMax - (inrWeightMax - inrWeightMin)
-                         * static_cast<double>(step) / lastIterNumber;
+    auto row = kernels::ParticleRow<T>{swarm.position(particle), swarm.velocity(particle),
+                                       swarm.bestPosition(particle), gBestPos.data(),
+                                       first, second};
+#if CLAMP_VELOCITY
+    auto velocityLimit = maxVelocity;
 #else
-    particle.velocity *= inertiaWeight;
+    auto velocityLimit = std::numeric_limits<T>::infinity();
 #endif
+    auto coefs = kernels::SwarmCoefs<T>{weight, static_cast<T>(cognitiveForceCoef),
+                                        static_cast<T>(socialForceCoef), velocityLimit};
+    kernels::updateParticle(row, coefs, swarm.dimensions);
 
-    particle.velocity += cognitiveForce + socialForce;
-
-#if CLAMP_VELOCITY
-    clampVelocities(particle);
+#if RETURN_TO_BOUND
+    retParticleToBound(particle);
 #endif
 
 #if CALCULATE_AVERAGE_VELOCITY
-    particle.averageVelocity = particle.velocity.sum() / particle.velocity.size();
+    auto velocity = swarm.velocity(particle);
+    swarm.averageVelocity[particle] = std::accumulate(velocity, velocity + swarm.dimensions,
+                                                      T{0}) / swarm.dimensions;
 #endif
 }
 
-template <size_t swarmSize>
-void Pso<swarmSize>::updatePersonalBest()
+template <typename T>
+void DynamicPso<T>::updatePersonalBest()
 {
-    for (auto& particle : swarmColony) {
-        auto res = fn(particle.currentPosition);
-        if (res < particle.personalBest) {
-            particle.personalBest = res;
-            particle.personalBestPos = particle.currentPosition;
+    forEachParticle([this](size_t first, size_t last, size_t worker) {
+        evaluateSwarm(first, last, worker);
+
+        for (size_t particle = first; particle < last; ++particle) {
+            auto res = fitness[particle];
+            if (res < swarm.personalBest[particle]) {
+                auto position = swarm.position(particle);
+                swarm.personalBest[particle] = res;
+                std::copy(position, position + swarm.dimensions, swarm.bestPosition(particle));
+            }
         }
-    }
+    });
 }
 
-template <size_t swarmSize>
-void Pso<swarmSize>::updateGlobalBest()
+/**
+ * Runs on the calling thread after the parallel phase. Particles
+ * are scanned in index order and ties keep the lower index, so the
+ * reduction is the same for any thread count.
+ */
+template <typename T>
+void DynamicPso<T>::updateGlobalBest()
 {
     auto isGbestChanged = false;
-    auto& bestParticle = swarmColony[0];
+    auto bestParticle = size_t{0};
 
-    for (auto& particle : swarmColony) {
-        if (particle.personalBest < gBest) {
-            gBest = particle.personalBest;
+    for (size_t particle = 0; particle < swarm.particles; ++particle) {
+        if (swarm.personalBest[particle] < gBest) {
+            gBest = swarm.personalBest[particle];
             bestParticle = particle;
             isGbestChanged = true;
         }
     }
 
-    /**
-     * TODO: Think about another stop criteria
-     *       or improve an approach based on checking
-     *       average swarm velocities.
-     *
-     *       This ugly workaround MUST BE removed !!!
-     */
     if (isGbestChanged) {
-        gBestPos = bestParticle.personalBestPos;
-        maybeStuck = false;
-    } else {
-        maybeStuck = true;
+        auto position = swarm.bestPosition(bestParticle);
+        std::copy(position, position + swarm.dimensions, begin(gBestPos));
     }
 }
 
-template <size_t swarmSize>
-void Pso<swarmSize>::updateParticle()
+template <typename T>
+void DynamicPso<T>::updateSwarm()
 {
-    for (auto& particle : swarmColony) {
-        updateVelocity(particle);
-        updatePosition(particle);
-    }
+    /**
+     * TODO: Implement calculation for inertia weight
+     *       which should decrease from 0.9 to 0.4.
+     *       Current implementation is bad. DO NOT USE IT !!!.
+     */
+#if DYNAMIC_INERTIA_WEIGHT
+    auto weight = static_cast<T>(inrWeightMax - (inrWeightMax - inrWeightMin)
+                                       * static_cast<double>(step) / lastIterNumber);
+#else
+    auto weight = static_cast<T>(inertiaWeight);
+#endif
+
+    forEachParticle([this, weight](size_t first, size_t last, size_t worker) {
+        for (size_t particle = first; particle < last; ++particle) {
+            updateParticle(particle, weight, worker);
+        }
+    });
 }
 
-template <size_t swarmSize>
-void Pso<swarmSize>::convergenceStep()
+template <typename T>
+void DynamicPso<T>::convergenceStep()
 {
-    updateParticle();
-    updatePersonalBest();
-    updateGlobalBest();
+    {
+        auto timer = utils::PhaseTimer(stats.velocityUpdateSeconds);
+        updateSwarm();
+    }
+    {
+        auto timer = utils::PhaseTimer(stats.evaluationSeconds);
+        updatePersonalBest();
+    }
+    {
+        auto timer = utils::PhaseTimer(stats.reductionSeconds);
+        updateGlobalBest();
+    }
 
 #if DYNAMIC_INERTIA_WEIGHT
     ++step;
 #endif
 }
 
-template <size_t swarmSize>
-bool Pso<swarmSize>::isConverged()
+template <typename T>
+bool DynamicPso<T>::isFinished()
 {
-#if CALCULATE_AVERAGE_VELOCITY
-    auto sum = value_t{0.0};
-    for (const auto& particle : swarmColony) {
-        sum += particle.averageVelocity;
+    if (channel && channel->isCancelled()) {
+        stats.stopReason = StopReason::Cancelled;
+        return true;
     }
 
-    auto averageSwarmVelocity = sum / swarmColony.size();
+#if CALCULATE_AVERAGE_VELOCITY
+    auto sum = std::accumulate(begin(swarm.averageVelocity), end(swarm.averageVelocity),
+                               T{0.0});
+    auto averageSwarmVelocity = sum / swarm.particles;
 
     if ((averageSwarmVelocity < eps) && isStuckOrConverged) {
-        stopCounter--;
+        stopCounter++;
     } else if ((averageSwarmVelocity < eps)) {
         isStuckOrConverged = true;
     } else {
         isStuckOrConverged = false;
-        stopCounter = lastIterNumber;
+        stopCounter = 0;
     }
-#else
-    if (maybeStuck) {
-        stopCounter--;
-    } else {
-        stopCounter = lastIterNumber;
+
+    // a swarm at rest stagnates too, whatever its gBest does
+    auto window = termination.getPolicy().stagnationWindow;
+    if (window && stopCounter >= window) {
+        stats.stopReason = StopReason::Stagnation;
+        return true;
     }
 #endif
 
-    if (stopCounter) {
+    if (!termination(stats.iterations, stats.evaluations, static_cast<double>(gBest))) {
         return false;
     }
+
+    stats.stopReason = termination.getReason();
     return true;
 }
 
-#if CALCULATE_AVERAGE_VELOCITY
-template <size_t swarmSize>
-Pso<swarmSize>::Pso(Function& f, double cognitiveForceCoef, double socialForceCoef,
-                    double inertiaWeight, value_t eps)
-#else
-template <size_t swarmSize>
-Pso<swarmSize>::Pso(Function& f, double cognitiveForceCoef, double socialForceCoef,
-                    double inertiaWeight)
-#endif
+template <typename T>
+void DynamicPso<T>::setTermination(const TerminationPolicy& policy)
 {
+    termination = Termination(policy);
+    termination.start(stats.iterations, stats.evaluations, static_cast<double>(gBest));
+    stats.stopReason = StopReason::None;
+}
+
+template <typename T>
+DynamicPso<T>::DynamicPso(size_t swarmSize, Function<T>& f, double cognitiveForceCoef,
+                          double socialForceCoef, double inertiaWeight,
+                          std::optional<std::uint64_t> seed, T eps)
+    : engine(seed ? *seed : rgen::makeSeed())
+{
+    if (!swarmSize) {
+        throw std::invalid_argument("Swarm must have at least one particle.");
+    }
+
     this->cognitiveForceCoef = cognitiveForceCoef;
     this->socialForceCoef = socialForceCoef;
     this->inertiaWeight = inertiaWeight;
-#if CALCULATE_AVERAGE_VELOCITY
     this->eps = eps;
-#endif
     fn = f;
 
     auto limits = fn.getFuncLimits();
+    auto dimensions = fn.getDimensions();
     maxVelocity = 0.5 * (limits.second - limits.first);
     step = 0;
 
+    swarm.resize(swarmSize, dimensions);
+    gBestPos.resize(dimensions);
+    rfirst.resize(swarm.stride);
+    rsecond.resize(swarm.stride);
+    arguments.assign(1, std::valarray<T>(dimensions));
+    particleEngines.resize(swarm.particles);
+    fitness.resize(swarm.particles);
+
     initParticlePos();
-    initVelocity();
 
-    auto min = std::numeric_limits<double>::max();
-    auto& bestParticle = swarmColony[0];
-    for (auto& particle : swarmColony) {
-        if (particle.personalBest < min) {
-            min = particle.personalBest;
-            bestParticle = particle;
-        }
+    auto bestParticle = static_cast<size_t>(std::distance(begin(swarm.personalBest),
+            std::min_element(begin(swarm.personalBest), end(swarm.personalBest))));
+    auto position = swarm.bestPosition(bestParticle);
+
+    gBest = swarm.personalBest[bestParticle];
+    std::copy(position, position + dimensions, begin(gBestPos));
+    stats.evaluations = swarm.particles;
+    stats.globalBest = gBest;
+    termination.start(stats.iterations, stats.evaluations, static_cast<double>(gBest));
+}
+
+/**
+ * One iteration, unless the termination policy says to stop;
+ * returns false in that case.
+ */
+template <typename T>
+bool DynamicPso<T>::iterate()
+{
+    if (isFinished()) {
+        return false;
     }
 
-    gBest = bestParticle.personalBest;
-    gBestPos = bestParticle.personalBestPos;
+    convergenceStep();
+    ++stats.iterations;
+    stats.evaluations += swarm.particles;
+    stats.globalBest = gBest;
+    reportStats(stats);
+    publishBest();
+    return true;
 }
 
-template <size_t swarmSize>
-std::pair<value_t, std::valarray<value_t>> Pso<swarmSize>::operator()()
+/**
+ * Runs on the solving thread, the only writer of the channel,
+ * and copies the position only when gBest improved.
+ */
+template <typename T>
+void DynamicPso<T>::publishBest()
 {
-    while (!isConverged()) {
-        convergenceStep();
-#if PRINT_BEST
-        std::cout << "(DEBUG PRINT) Best = " << gBest << std::endl;
-#endif
+    if (!channel || !(gBest < publishedBest)) {
+        return;
     }
-    return std::make_pair(gBest, gBestPos);
+
+    publishedBest = gBest;
+    channel->publish([this](PsoSnapshot<T>& snapshot) {
+        snapshot.value = gBest;
+        snapshot.position.assign(begin(gBestPos), end(gBestPos));
+        snapshot.iterations = stats.iterations;
+    });
 }
 
+template <typename T>
+std::pair<T, std::valarray<T>> DynamicPso<T>::operator()()
+{
+    termination.start(stats.iterations, stats.evaluations, static_cast<double>(gBest));
+    stats.stopReason = StopReason::None;
+    while (iterate()) {}
+    return std::make_pair(gBest, std::valarray<T>(gBestPos.data(), gBestPos.size()));
+}
+
+/**
+ * The starting gBest is published right away, so the handle
+ * has a snapshot from the first poll on. The channel is detached
+ * when the solve ends, even by an exception.
+ */
+template <typename T>
+SolveHandle<PsoSnapshot<T>, std::pair<T, std::valarray<T>>> DynamicPso<T>::solveAsync()
+{
+    auto shared = std::make_shared<SolveChannel<PsoSnapshot<T>>>();
+    channel = shared;
+    publishedBest = std::numeric_limits<T>::max();
+    publishBest();
+
+    auto result = std::async(std::launch::async, [this]() {
+        auto detach = ChannelDetach<PsoSnapshot<T>>(channel);
+        return (*this)();
+    });
+    return {std::move(shared), std::move(result)};
+}
+
+/**
+ * Copies the personal bests of the count best particles,
+ * best first. Returns the number of particles copied.
+ */
+template <typename T>
+size_t DynamicPso<T>::emigrate(size_t count, T* fitness, T* positions)
+{
+    count = std::min(count, swarm.particles);
+    migrationOrder.resize(swarm.particles);
+    std::iota(begin(migrationOrder), end(migrationOrder), size_t{0});
+    std::partial_sort(begin(migrationOrder), begin(migrationOrder) + count, end(migrationOrder),
+        [this](auto lhs, auto rhs) { return swarm.personalBest[lhs] < swarm.personalBest[rhs]; });
+
+    for (size_t index = 0; index < count; ++index) {
+        auto position = swarm.bestPosition(migrationOrder[index]);
+        fitness[index] = swarm.personalBest[migrationOrder[index]];
+        std::copy(position, position + swarm.dimensions, positions + index * swarm.dimensions);
+    }
+    return count;
+}
+
+/**
+ * Incoming particles replace the worst ones of the swarm, if
+ * they are better, and start at rest from their best position.
+ */
+template <typename T>
+void DynamicPso<T>::immigrate(size_t count, const T* fitness, const T* positions)
+{
+    count = std::min(count, swarm.particles);
+    migrationOrder.resize(swarm.particles);
+    std::iota(begin(migrationOrder), end(migrationOrder), size_t{0});
+    std::partial_sort(begin(migrationOrder), begin(migrationOrder) + count, end(migrationOrder),
+        [this](auto lhs, auto rhs) { return swarm.personalBest[lhs] > swarm.personalBest[rhs]; });
+
+    for (size_t index = 0; index < count; ++index) {
+        auto particle = migrationOrder[index];
+        if (!(fitness[index] < swarm.personalBest[particle])) {
+            continue;
+        }
+
+        auto incoming = positions + index * swarm.dimensions;
+        auto velocity = swarm.velocity(particle);
+        std::copy(incoming, incoming + swarm.dimensions, swarm.position(particle));
+        std::copy(incoming, incoming + swarm.dimensions, swarm.bestPosition(particle));
+        std::fill(velocity, velocity + swarm.dimensions, T{0});
+        swarm.personalBest[particle] = fitness[index];
+
+        if (fitness[index] < gBest) {
+            gBest = fitness[index];
+            std::copy(incoming, incoming + swarm.dimensions, begin(gBestPos));
+        }
+    }
+}
+
+/**
+ * Swarm size fixed at compile time. All storage is sized at run
+ * time either way, so this is a thin wrapper over DynamicPso kept
+ * for existing code; it gives no speedup over DynamicPso.
+ */
+template <size_t swarmSize, typename T = value_t>
+class Pso : public DynamicPso<T>
+{
+    public:
+        Pso() = default;
+        Pso(Function<T>& f, double cognitiveForceCoef, double socialForceCoef,
+            double inertiaWeight, std::optional<std::uint64_t> seed = std::nullopt,
+            T eps = ai::eps)
+            : DynamicPso<T>(swarmSize, f, cognitiveForceCoef, socialForceCoef,
+                            inertiaWeight, seed, eps) {};
+        Pso(Function<T>& f) : DynamicPso<T>(swarmSize, f) {};
+        ~Pso() = default;
+};
+
 } // ai
 
-#endif // __AI_PSO_HPP__
\ No newline at end of file
+#endif // __AI_PSO_HPP__
@@ -0,0 +1,101 @@
+/**
+ * file: psoKernels.hpp
+ * synopsis: Vectorized velocity and position
+ *           update kernels for pso
+ * author: Vladyslav Podilnyk
+ */
+
+#ifndef __AI_PSO_KERNELS_HPP__
+#define __AI_PSO_KERNELS_HPP__
+
+#include <algorithm>
+#include <cstddef>
+#include "simd.hpp"
+
+namespace ai::kernels {
+
+/**
+ * Arguments of one velocity/position update. Pointers refer
+ * to rows of a swarm stored as structure of arrays.
+ */
+template <typename T>
+struct ParticleRow
+{
+    T* position;
+    T* velocity;
+    const T* personalBestPos;
+    const T* globalBestPos;
+    const T* rfirst;
+    const T* rsecond;
+};
+
+template <typename T>
+struct SwarmCoefs
+{
+    T inertiaWeight;
+    T cognitiveForceCoef;
+    T socialForceCoef;
+    T maxVelocity;
+};
+
+/**
+ * v = w * v + c1 * r1 * (pBest - x) + c2 * r2 * (gBest - x),
+ * v = min(v, vMax), x += v, for elements [first, dimensions).
+ */
+template <typename T>
+inline void updateParticleScalar(const ParticleRow<T>& row, const SwarmCoefs<T>& coefs,
+                                 size_t first, size_t dimensions)
+{
+    for (size_t index = first; index < dimensions; ++index) {
+        auto position = row.position[index];
+        auto velocity = coefs.inertiaWeight * row.velocity[index]
+            + coefs.cognitiveForceCoef * row.rfirst[index]
+                * (row.personalBestPos[index] - position)
+            + coefs.socialForceCoef * row.rsecond[index]
+                * (row.globalBestPos[index] - position);
+        velocity = std::min(velocity, coefs.maxVelocity);
+        row.velocity[index] = velocity;
+        row.position[index] = position + velocity;
+    }
+}
+
+template <typename Lanes>
+inline size_t updateParticleLanes(const ParticleRow<typename Lanes::scalar>& row,
+                                  const SwarmCoefs<typename Lanes::scalar>& coefs,
+                                  size_t dimensions)
+{
+    auto inertia = Lanes::set(coefs.inertiaWeight);
+    auto cognitive = Lanes::set(coefs.cognitiveForceCoef);
+    auto social = Lanes::set(coefs.socialForceCoef);
+    auto maxVelocity = Lanes::set(coefs.maxVelocity);
+
+    auto index = size_t{0};
+    for (; index + Lanes::width <= dimensions; index += Lanes::width) {
+        auto position = Lanes::load(row.position + index);
+        auto cognitiveForce = Lanes::mul(Lanes::mul(cognitive, Lanes::load(row.rfirst + index)),
+                Lanes::sub(Lanes::load(row.personalBestPos + index), position));
+        auto socialForce = Lanes::mul(Lanes::mul(social, Lanes::load(row.rsecond + index)),
+                Lanes::sub(Lanes::load(row.globalBestPos + index), position));
+        auto velocity = Lanes::mul(inertia, Lanes::load(row.velocity + index));
+        velocity = Lanes::min(Lanes::add(velocity, Lanes::add(cognitiveForce, socialForce)),
+                              maxVelocity);
+        Lanes::store(row.velocity + index, velocity);
+        Lanes::store(row.position + index, Lanes::add(position, velocity));
+    }
+    return index;
+}
+
+template <typename T>
+inline void updateParticle(const ParticleRow<T>& row, const SwarmCoefs<T>& coefs,
+                           size_t dimensions)
+{
+    auto first = size_t{0};
+    if constexpr (simd::NativeLanes<T>::width > 1) {
+        first = updateParticleLanes<simd::NativeLanes<T>>(row, coefs, dimensions);
+    }
+    updateParticleScalar(row, coefs, first, dimensions);
+}
+
+} // kernels
+
+#endif // __AI_PSO_KERNELS_HPP__
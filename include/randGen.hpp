@@ -1,6 +1,6 @@
 /**
  * file: randGen.hpp
- * synopsis: Implementation of random 
+ * synopsis: Implementation of random
  *           generator.
  * author: Vladyslav Podilnyk
  */
@@ -8,44 +8,131 @@
 #ifndef __AI_RANDGEN_HPP__
 #define __AI_RANDGEN_HPP__
 
+#include <cstdint>
+#include <limits>
 #include <random>
-#include <utility>
-#include <vector>
-#include <algorithm>
-#include "utils.hpp"
 
-using ai::utils::value_t;
+#ifndef AI_MT19937
+#define AI_MT19937 0
+#endif
 
 namespace ai::rgen {
 
-template <typename T = value_t, 
-          typename Distribution = std::uniform_real_distribution<T>,
-          typename CustomGen = std::mt19937_64>
-class RandGen
+/**
+ * SplitMix64 step, used to expand a single 64-bit
+ * seed into the state of a bigger generator.
+ */
+inline std::uint64_t splitMix64(std::uint64_t& state)
+{
+    auto result = (state += 0x9e3779b97f4a7c15ULL);
+    result = (result ^ (result >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    result = (result ^ (result >> 27)) * 0x94d049bb133111ebULL;
+    return result ^ (result >> 31);
+}
+
+/**
+ * xoshiro256** by D. Blackman and S. Vigna. 32 bytes of state
+ * and a handful of instructions per value, compared to 2.5 KB
+ * for std::mt19937_64. Satisfies UniformRandomBitGenerator, so
+ * it plugs into any <random> distribution.
+ */
+class Xoshiro256
 {
     public:
-        RandGen(std::pair<T, T> limits)
-            : dist{limits.first, limits.second} {};
-
-        auto generate(size_t size) {
-            std::random_device seed;
-            CustomGen randNumberGen(seed());
-            auto container = std::valarray<T>(size);
-            std::generate(begin(container), end(container),
-                          [&]() { return dist(randNumberGen); });
-            return container;
+        using result_type = std::uint64_t;
+
+        Xoshiro256() : Xoshiro256(0) {};
+        explicit Xoshiro256(std::uint64_t seedValue) { seed(seedValue); };
+
+        void seed(std::uint64_t seedValue) {
+            for (auto& word : state) {
+                word = splitMix64(seedValue);
+            }
         }
 
-        auto randValue() {
-            std::random_device seed;
-            CustomGen randNumberGen(seed());
-            return dist(randNumberGen);
+        result_type operator()() {
+            auto result = rotl(state[1] * 5, 7) * 9;
+            auto temp = state[1] << 17;
+
+            state[2] ^= state[0];
+            state[3] ^= state[1];
+            state[1] ^= state[2];
+            state[0] ^= state[3];
+            state[2] ^= temp;
+            state[3] = rotl(state[3], 45);
+
+            return result;
+        }
+
+        static constexpr result_type min() { return 0; };
+        static constexpr result_type max() { return std::numeric_limits<result_type>::max(); };
+
+    private:
+        static std::uint64_t rotl(std::uint64_t value, int shift) {
+            return (value << shift) | (value >> (64 - shift));
         }
 
+        std::uint64_t state[4];
+};
+
+/**
+ * Uniform double in [0, 1) built from the top 53 bits
+ * of a 64-bit engine; cheaper than a distribution object.
+ */
+template <typename Engine>
+inline double canonical(Engine& engine)
+{
+    return (engine() >> 11) * 0x1.0p-53;
+}
+
+/**
+ * Non-deterministic seed. Only meant to be called once
+ * per engine, never per generated value.
+ */
+inline std::uint64_t makeSeed()
+{
+    std::random_device seed;
+    return (static_cast<std::uint64_t>(seed()) << 32) ^ seed();
+}
+
+/**
+ * Engine of the optimizers. Built with AI_MT19937 set to 1 they
+ * draw from std::mt19937_64 instead, which is slower and has 2.5 KB
+ * of state, but is the generator older results were produced with.
+ */
+#if AI_MT19937
+using DefaultEngine = std::mt19937_64;
+#else
+using DefaultEngine = Xoshiro256;
+#endif
+
+/**
+ * RandGen owns a long-lived engine, seeded once on construction;
+ * pass the same seed to get the same sequence. A default constructed
+ * RandGen uses the engine's fixed default seed and is meant to be
+ * replaced by a seeded one. RandGen is a UniformRandomBitGenerator
+ * itself, so it plugs into any <random> distribution.
+ */
+template <typename Engine = DefaultEngine>
+class RandGen
+{
+    public:
+        using result_type = typename Engine::result_type;
+
+        RandGen() = default;
+        explicit RandGen(std::uint64_t seed) : engine(seed) {};
+
+        result_type operator()() { return engine(); };
+        double canonical() { return rgen::canonical(engine); };
+
+        static constexpr result_type min() { return Engine::min(); };
+        static constexpr result_type max() { return Engine::max(); };
+        Engine& getEngine() { return engine; };
+
     private:
-        Distribution dist;
+        Engine engine;
 };
 
 } // rgen
 
-#endif // __AI_RANDGEN_HPP__
\ No newline at end of file
+#endif // __AI_RANDGEN_HPP__
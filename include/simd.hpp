@@ -0,0 +1,286 @@
+/**
+ * file: simd.hpp
+ * synopsis: Portable wrappers around
+ *           SIMD intrinsics
+ * author: Vladyslav Podilnyk
+ */
+
+#ifndef __AI_SIMD_HPP__
+#define __AI_SIMD_HPP__
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+namespace ai::simd {
+
+/**
+ * Thin wrappers around the intrinsics of one instruction set,
+ * so a single kernel body serves every width and scalar type.
+ * Only the widest set enabled at compile time is used,
+ * see -DAI_NATIVE_ARCH=ON. ScalarLanes is the one-element
+ * fallback used for loop tails and for long double.
+ *
+ * AVX-512 min, max and round use the zero-masked forms; the plain ones trip
+ * a -Wmaybe-uninitialized false positive in GCC 12 headers.
+ */
+template <typename T>
+struct ScalarLanes
+{
+    using scalar = T;
+    using vector = T;
+    static constexpr size_t width = 1;
+    static vector load(const T* ptr) { return *ptr; };
+    static void store(T* ptr, vector value) { *ptr = value; };
+    static vector set(T value) { return value; };
+    static vector iota(T first) { return first; };
+    static vector add(vector a, vector b) { return a + b; };
+    static vector sub(vector a, vector b) { return a - b; };
+    static vector mul(vector a, vector b) { return a * b; };
+    static vector div(vector a, vector b) { return a / b; };
+    static vector min(vector a, vector b) { return std::min(a, b); };
+    static vector max(vector a, vector b) { return std::max(a, b); };
+    static vector round(vector a) { return std::nearbyint(a); };
+};
+
+#if defined(__AVX512F__)
+struct DoubleLanes
+{
+    using scalar = double;
+    using vector = __m512d;
+    static constexpr size_t width = 8;
+    static vector load(const double* ptr) { return _mm512_loadu_pd(ptr); };
+    static void store(double* ptr, vector value) { _mm512_storeu_pd(ptr, value); };
+    static vector set(double value) { return _mm512_set1_pd(value); };
+    static vector iota(double first) {
+        return _mm512_add_pd(set(first), _mm512_setr_pd(0, 1, 2, 3, 4, 5, 6, 7));
+    };
+    static vector add(vector a, vector b) { return _mm512_add_pd(a, b); };
+    static vector sub(vector a, vector b) { return _mm512_sub_pd(a, b); };
+    static vector mul(vector a, vector b) { return _mm512_mul_pd(a, b); };
+    static vector div(vector a, vector b) { return _mm512_div_pd(a, b); };
+    static vector min(vector a, vector b) { return _mm512_maskz_min_pd(0xff, a, b); };
+    static vector max(vector a, vector b) { return _mm512_maskz_max_pd(0xff, a, b); };
+    static vector round(vector a) {
+        return _mm512_maskz_roundscale_pd(0xff, a, _MM_FROUND_TO_NEAREST_INT);
+    };
+};
+
+struct FloatLanes
+{
+    using scalar = float;
+    using vector = __m512;
+    static constexpr size_t width = 16;
+    static vector load(const float* ptr) { return _mm512_loadu_ps(ptr); };
+    static void store(float* ptr, vector value) { _mm512_storeu_ps(ptr, value); };
+    static vector set(float value) { return _mm512_set1_ps(value); };
+    static vector iota(float first) {
+        return _mm512_add_ps(set(first), _mm512_setr_ps(0, 1, 2, 3, 4, 5, 6, 7,
+                                                         8, 9, 10, 11, 12, 13, 14, 15));
+    };
+    static vector add(vector a, vector b) { return _mm512_add_ps(a, b); };
+    static vector sub(vector a, vector b) { return _mm512_sub_ps(a, b); };
+    static vector mul(vector a, vector b) { return _mm512_mul_ps(a, b); };
+    static vector div(vector a, vector b) { return _mm512_div_ps(a, b); };
+    static vector min(vector a, vector b) { return _mm512_maskz_min_ps(0xffff, a, b); };
+    static vector max(vector a, vector b) { return _mm512_maskz_max_ps(0xffff, a, b); };
+    static vector round(vector a) {
+        return _mm512_maskz_roundscale_ps(0xffff, a, _MM_FROUND_TO_NEAREST_INT);
+    };
+};
+#elif defined(__AVX2__)
+struct DoubleLanes
+{
+    using scalar = double;
+    using vector = __m256d;
+    static constexpr size_t width = 4;
+    static vector load(const double* ptr) { return _mm256_loadu_pd(ptr); };
+    static void store(double* ptr, vector value) { _mm256_storeu_pd(ptr, value); };
+    static vector set(double value) { return _mm256_set1_pd(value); };
+    static vector iota(double first) {
+        return _mm256_add_pd(set(first), _mm256_setr_pd(0, 1, 2, 3));
+    };
+    static vector add(vector a, vector b) { return _mm256_add_pd(a, b); };
+    static vector sub(vector a, vector b) { return _mm256_sub_pd(a, b); };
+    static vector mul(vector a, vector b) { return _mm256_mul_pd(a, b); };
+    static vector div(vector a, vector b) { return _mm256_div_pd(a, b); };
+    static vector min(vector a, vector b) { return _mm256_min_pd(a, b); };
+    static vector max(vector a, vector b) { return _mm256_max_pd(a, b); };
+    static vector round(vector a) {
+        return _mm256_round_pd(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    };
+};
+
+struct FloatLanes
+{
+    using scalar = float;
+    using vector = __m256;
+    static constexpr size_t width = 8;
+    static vector load(const float* ptr) { return _mm256_loadu_ps(ptr); };
+    static void store(float* ptr, vector value) { _mm256_storeu_ps(ptr, value); };
+    static vector set(float value) { return _mm256_set1_ps(value); };
+    static vector iota(float first) {
+        return _mm256_add_ps(set(first), _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7));
+    };
+    static vector add(vector a, vector b) { return _mm256_add_ps(a, b); };
+    static vector sub(vector a, vector b) { return _mm256_sub_ps(a, b); };
+    static vector mul(vector a, vector b) { return _mm256_mul_ps(a, b); };
+    static vector div(vector a, vector b) { return _mm256_div_ps(a, b); };
+    static vector min(vector a, vector b) { return _mm256_min_ps(a, b); };
+    static vector max(vector a, vector b) { return _mm256_max_ps(a, b); };
+    static vector round(vector a) {
+        return _mm256_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    };
+};
+#endif
+
+/**
+ * Widest lanes available for T.
+ */
+template <typename T>
+struct NativeLanesFor { using type = ScalarLanes<T>; };
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+template <>
+struct NativeLanesFor<double> { using type = DoubleLanes; };
+
+template <>
+struct NativeLanesFor<float> { using type = FloatLanes; };
+#endif
+
+template <typename T>
+using NativeLanes = typename NativeLanesFor<T>::type;
+
+/**
+ * Folds op(lanes, i, a[i], b[i], ...) over i in [0, count) with
+ * combine(lanes, accumulator, value), where i comes as lanes holding
+ * consecutive element indices. Both callables are generic lambdas
+ * taking the lanes type as a tag, so one body covers the vector loop
+ * and the scalar tail.
+ */
+template <typename T, typename Combine, typename Operation, typename... Arrays>
+inline T reduceIndexed(size_t count, T identity, Combine combine, Operation op,
+                       const Arrays*... arrays)
+{
+    using Lanes = NativeLanes<T>;
+    using Scalar = ScalarLanes<T>;
+
+    auto index = size_t{0};
+    auto result = identity;
+
+    if constexpr (Lanes::width > 1) {
+        auto accumulator = Lanes::set(identity);
+        for (; index + Lanes::width <= count; index += Lanes::width) {
+            auto value = op(Lanes{}, Lanes::iota(static_cast<T>(index)),
+                            Lanes::load(arrays + index)...);
+            accumulator = combine(Lanes{}, accumulator, value);
+        }
+
+        alignas(64) T lanes[Lanes::width];
+        Lanes::store(lanes, accumulator);
+        for (auto value : lanes) {
+            result = combine(Scalar{}, result, value);
+        }
+    }
+
+    for (; index < count; ++index) {
+        result = combine(Scalar{}, result,
+                         op(Scalar{}, static_cast<T>(index), arrays[index]...));
+    }
+    return result;
+}
+
+/**
+ * reduceIndexed() for an op(lanes, a[i], b[i], ...) that does not
+ * need the element index.
+ */
+template <typename T, typename Combine, typename Operation, typename... Arrays>
+inline T reduce(size_t count, T identity, Combine combine, Operation op,
+                const Arrays*... arrays)
+{
+    return reduceIndexed(count, identity, combine,
+                         [&op](auto lanes, auto, auto... values) { return op(lanes, values...); },
+                         arrays...);
+}
+
+/**
+ * data[i] = op(lanes, data[i]) for i in [0, count), in place.
+ */
+template <typename T, typename Operation>
+inline void transform(T* data, size_t count, Operation op)
+{
+    using Lanes = NativeLanes<T>;
+    using Scalar = ScalarLanes<T>;
+
+    auto index = size_t{0};
+    if constexpr (Lanes::width > 1) {
+        for (; index + Lanes::width <= count; index += Lanes::width) {
+            Lanes::store(data + index, op(Lanes{}, Lanes::load(data + index)));
+        }
+    }
+
+    for (; index < count; ++index) {
+        data[index] = op(Scalar{}, data[index]);
+    }
+}
+
+/**
+ * Coefficients (-1)^n / (2n)! of the Taylor series of cos.
+ * Truncated after x^26, which keeps the error below 3e-16
+ * on [-pi, pi].
+ */
+template <typename T>
+struct CosCoefs
+{
+    static constexpr size_t size = 14;
+
+    constexpr CosCoefs() : values{} {
+        auto term = 1.0L;
+        for (size_t n = 0; n < size; ++n) {
+            values[n] = static_cast<T>(term);
+            term = -term / ((2 * n + 1) * (2 * n + 2));
+        }
+    }
+
+    T values[size];
+};
+
+/**
+ * Lane-wise cosine: reduce to [-pi, pi] with a two-part 2*pi
+ * (Cody-Waite), then evaluate the even polynomial in x^2.
+ * Single lanes fall back to std::cos to keep long double exact.
+ */
+template <typename Lanes>
+inline typename Lanes::vector cos(typename Lanes::vector x)
+{
+    using T = typename Lanes::scalar;
+
+    if constexpr (Lanes::width == 1) {
+        return std::cos(x);
+    } else {
+        constexpr auto twoPi = 6.283185307179586476925286766559L;
+        constexpr auto twoPiHigh = static_cast<T>(twoPi);
+        constexpr auto twoPiLow = static_cast<T>(twoPi - twoPiHigh);
+        constexpr auto coefs = CosCoefs<T>{};
+
+        auto turns = Lanes::round(Lanes::mul(x, Lanes::set(static_cast<T>(1 / twoPi))));
+        auto reduced = Lanes::sub(x, Lanes::mul(turns, Lanes::set(twoPiHigh)));
+        reduced = Lanes::sub(reduced, Lanes::mul(turns, Lanes::set(twoPiLow)));
+        auto square = Lanes::mul(reduced, reduced);
+
+        auto result = Lanes::set(coefs.values[CosCoefs<T>::size - 1]);
+        for (size_t n = CosCoefs<T>::size - 1; n-- > 0;) {
+            result = Lanes::add(Lanes::mul(result, square), Lanes::set(coefs.values[n]));
+        }
+        return result;
+    }
+}
+
+} // simd
+
+#endif // __AI_SIMD_HPP__
@@ -0,0 +1,125 @@
+/**
+ * file: solveHandle.hpp
+ * synopsis: Handle of a solve running on a background
+ *           thread, with best-so-far snapshots
+ * author: Vladyslav Podilnyk
+ */
+
+#ifndef __AI_SOLVE_HANDLE_HPP__
+#define __AI_SOLVE_HANDLE_HPP__
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include "tripleBuffer.hpp"
+
+namespace ai {
+
+/**
+ * Shared by a running solver and its handle. The solver is the
+ * only writer of the best-so-far slot, a utils::TripleBuffer, so
+ * publishing never waits for readers; readers only serialize among
+ * themselves. Cancellation is a relaxed flag the solver checks once
+ * per iteration.
+ */
+template <typename Best>
+class SolveChannel
+{
+    public:
+        // solver side; fill(Best&) overwrites the whole value
+        template <typename Fill>
+        void publish(Fill fill) {
+            fill(slot.back());
+            slot.publish();
+        }
+        bool isCancelled() const { return cancelled.load(std::memory_order_relaxed); };
+
+        // handle side
+        std::optional<Best> latest() {
+            auto lock = std::lock_guard<std::mutex>(readMutex);
+            hasValue = slot.update() || hasValue;
+            if (!hasValue) {
+                return std::nullopt;
+            }
+            return slot.front();
+        }
+        void cancel() { cancelled.store(true, std::memory_order_relaxed); };
+
+    private:
+        utils::TripleBuffer<Best> slot;
+        std::mutex readMutex;
+        bool hasValue = false;
+        std::atomic<bool> cancelled{false};
+};
+
+/**
+ * Scope guard a solver holds while solveAsync() runs it: drops the
+ * solver's reference to the channel on the way out, even when the
+ * solve throws, so later synchronous solves publish nothing.
+ */
+template <typename Best>
+class ChannelDetach
+{
+    public:
+        explicit ChannelDetach(std::shared_ptr<SolveChannel<Best>>& channel) : channel{channel} {};
+        ChannelDetach(const ChannelDetach&) = delete;
+        ChannelDetach& operator=(const ChannelDetach&) = delete;
+        ~ChannelDetach() { channel.reset(); };
+
+    private:
+        std::shared_ptr<SolveChannel<Best>>& channel;
+};
+
+/**
+ * Returned by the solveAsync() methods. poll() gives the latest
+ * best-so-far snapshot (none before the first one is found) without
+ * stopping the search, cancel() asks the solver to stop after its
+ * current iteration, and the future yields the final result, which
+ * after a cancellation is the best one found until then.
+ *
+ * Dropping a handle cancels its solve and waits for it to stop.
+ */
+template <typename Best, typename Result>
+class SolveHandle
+{
+    public:
+        SolveHandle(std::shared_ptr<SolveChannel<Best>> channel, std::future<Result> result)
+            : channel{std::move(channel)}, result{std::move(result)} {};
+        SolveHandle(SolveHandle&&) = default;
+        SolveHandle& operator=(SolveHandle&& other) {
+            if (this != &other) {
+                stop();
+                channel = std::move(other.channel);
+                result = std::move(other.result);
+            }
+            return *this;
+        }
+
+        std::optional<Best> poll() { return channel->latest(); };
+        void cancel() { channel->cancel(); };
+        bool isReady() const {
+            return result.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+        }
+        std::future<Result>& getFuture() { return result; };
+        Result get() { return result.get(); };
+
+        ~SolveHandle() { stop(); };
+
+    private:
+        void stop() {
+            if (channel && result.valid()) {
+                channel->cancel();
+                result.wait();
+            }
+        }
+
+        std::shared_ptr<SolveChannel<Best>> channel;
+        std::future<Result> result;
+};
+
+} // ai
+
+#endif // __AI_SOLVE_HANDLE_HPP__
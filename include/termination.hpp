@@ -0,0 +1,111 @@
+/**
+ * file: termination.hpp
+ * synopsis: Stop criteria shared by
+ *           the MMAS and PSO solvers
+ * author: Vladyslav Podilnyk
+ */
+
+#ifndef __AI_TERMINATION_HPP__
+#define __AI_TERMINATION_HPP__
+
+#include <chrono>
+#include <cmath>
+#include <optional>
+
+namespace ai {
+
+/**
+ * When a solver stops. Every limit set to 0 (or left empty) is off;
+ * the first one reached wins. Evaluations are objective function
+ * calls for PSO and ant steps for MMAS. Iterations, evaluations and
+ * time are counted from the start of the solve.
+ *
+ * The search has stagnated once the best value has not improved by
+ * more than minImprovement (relative to itself) for stagnationWindow
+ * iterations; minImprovement = 0 accepts any strict improvement.
+ */
+struct TerminationPolicy
+{
+    std::chrono::microseconds timeLimit{0};
+    size_t maxIterations = 0;
+    size_t maxEvaluations = 0;
+    std::optional<double> target = std::nullopt; // stop once best <= target
+    size_t stagnationWindow = 1000;
+    double minImprovement = 0.0;
+};
+
+enum class StopReason {None, Stagnation, TimeLimit, Iterations, Evaluations, Target, Cancelled};
+
+/**
+ * Running check of a TerminationPolicy. Solvers call it once per
+ * iteration with their counters and best value (lower is better);
+ * it costs a few comparisons and, with a time limit, one read of
+ * the steady clock.
+ */
+class Termination
+{
+    using Clock = std::chrono::steady_clock;
+
+    public:
+        Termination() = default;
+        explicit Termination(const TerminationPolicy& policy) : policy{policy} {};
+
+        void start(size_t iterations = 0, size_t evaluations = 0,
+                   double best = HUGE_VAL) {
+            deadline = Clock::now() + policy.timeLimit;
+            firstIteration = iterations;
+            firstEvaluation = evaluations;
+            windowBest = best;
+            improvedAt = iterations;
+            reason = StopReason::None;
+        }
+
+        /**
+         * Returns true once the solver has to stop,
+         * getReason() then tells which limit was hit.
+         */
+        bool operator()(size_t iterations, size_t evaluations, double best) {
+            auto threshold = std::isinf(windowBest)
+                             ? windowBest
+                             : windowBest - policy.minImprovement * std::fabs(windowBest);
+            if (best < threshold) {
+                windowBest = best;
+                improvedAt = iterations;
+            }
+
+            if (policy.target && best <= *policy.target) {
+                reason = StopReason::Target;
+            } else if (policy.maxIterations && iterations - firstIteration >= policy.maxIterations) {
+                reason = StopReason::Iterations;
+            } else if (policy.maxEvaluations
+                       && evaluations - firstEvaluation >= policy.maxEvaluations) {
+                reason = StopReason::Evaluations;
+            } else if (policy.stagnationWindow && iterations - improvedAt >= policy.stagnationWindow) {
+                reason = StopReason::Stagnation;
+            } else if (isOverdue()) {
+                reason = StopReason::TimeLimit;
+            }
+            return reason != StopReason::None;
+        }
+
+        // only reads the clock, so any thread may poll it during a solve
+        bool isOverdue() const {
+            return policy.timeLimit.count() && Clock::now() >= deadline;
+        }
+
+        StopReason getReason() const { return reason; };
+        const TerminationPolicy& getPolicy() const { return policy; };
+
+    private:
+        TerminationPolicy policy;
+        Clock::time_point deadline;
+        size_t firstIteration = 0;
+        size_t firstEvaluation = 0;
+        size_t improvedAt = 0;
+        double windowBest = HUGE_VAL;
+        StopReason reason = StopReason::None;
+};
+
+} // ai
+
+#endif // __AI_TERMINATION_HPP__
@@ -0,0 +1,154 @@
+/**
+ * file: threadPool.hpp
+ * synopsis: A small fixed-size thread pool
+ *           for data-parallel loops.
+ * author: Vladyslav Podilnyk
+ */
+
+#ifndef __AI_THREADPOOL_HPP__
+#define __AI_THREADPOOL_HPP__
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ai {
+
+/**
+ * Threads are started once and parked between calls, so
+ * parallelFor() costs a wake-up rather than a thread creation.
+ * The calling thread takes part in the work as worker #0.
+ *
+ * The range [0, count) is split statically: worker w always gets
+ * [count * w / n, count * (w + 1) / n). Together with per-worker
+ * state indexed by the worker id this keeps runs reproducible.
+ */
+class ThreadPool
+{
+    public:
+        using Task = std::function<void(size_t first, size_t last, size_t worker)>;
+
+        explicit ThreadPool(size_t threadsCount);
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        void parallelFor(size_t count, const Task& task);
+        size_t size() const { return workers.size() + 1; };
+        ~ThreadPool();
+
+    private:
+        void workerLoop(size_t worker);
+        void runChunk(size_t worker);
+
+        std::vector<std::thread> workers;
+        std::mutex submitMutex;
+        std::mutex mutex;
+        std::condition_variable wakeUp;
+        std::condition_variable finished;
+        const Task* task = nullptr;
+        std::exception_ptr error;
+        size_t count = 0;
+        size_t generation = 0;
+        size_t pending = 0;
+        bool stopping = false;
+};
+
+inline ThreadPool::ThreadPool(size_t threadsCount)
+{
+    for (size_t worker = 1; worker < threadsCount; ++worker) {
+        workers.emplace_back([this, worker]() { workerLoop(worker); });
+    }
+}
+
+inline void ThreadPool::runChunk(size_t worker)
+{
+    auto threads = size();
+    auto first = count * worker / threads;
+    auto last = count * (worker + 1) / threads;
+
+    try {
+        if (first < last) {
+            (*task)(first, last, worker);
+        }
+    } catch (...) {
+        auto lock = std::lock_guard<std::mutex>(mutex);
+        if (!error) {
+            error = std::current_exception();
+        }
+    }
+}
+
+inline void ThreadPool::workerLoop(size_t worker)
+{
+    auto seenGeneration = size_t{0};
+
+    while (true) {
+        {
+            auto lock = std::unique_lock<std::mutex>(mutex);
+            wakeUp.wait(lock, [&]() { return stopping || generation != seenGeneration; });
+            if (stopping) {
+                return;
+            }
+            seenGeneration = generation;
+        }
+
+        runChunk(worker);
+
+        auto lock = std::lock_guard<std::mutex>(mutex);
+        if (--pending == 0) {
+            finished.notify_one();
+        }
+    }
+}
+
+inline void ThreadPool::parallelFor(size_t count, const Task& task)
+{
+    auto submitLock = std::lock_guard<std::mutex>(submitMutex);
+
+    if (workers.empty()) {
+        if (count) {
+            task(0, count, 0);
+        }
+        return;
+    }
+
+    {
+        auto lock = std::lock_guard<std::mutex>(mutex);
+        this->task = &task;
+        this->count = count;
+        error = nullptr;
+        pending = workers.size();
+        ++generation;
+    }
+    wakeUp.notify_all();
+
+    runChunk(0);
+
+    auto lock = std::unique_lock<std::mutex>(mutex);
+    finished.wait(lock, [this]() { return pending == 0; });
+    this->task = nullptr;
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+inline ThreadPool::~ThreadPool()
+{
+    {
+        auto lock = std::lock_guard<std::mutex>(mutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+} // ai
+
+#endif // __AI_THREADPOOL_HPP__
@@ -0,0 +1,63 @@
+/**
+ * file: tripleBuffer.hpp
+ * synopsis: Lock-free single producer,
+ *           single consumer value exchange.
+ * author: Vladyslav Podilnyk
+ */
+
+#ifndef __AI_TRIPLE_BUFFER_HPP__
+#define __AI_TRIPLE_BUFFER_HPP__
+
+#include <atomic>
+
+namespace ai::utils {
+
+/**
+ * Three copies of Value: the writer fills back(), the reader looks
+ * at front(), and the third one sits in the middle. publish() and
+ * update() swap a private copy with the middle one in a single
+ * atomic exchange, so neither side ever waits for the other and
+ * no copy is ever touched by both threads at once. The reader
+ * always gets the latest published value; older ones are dropped.
+ *
+ * Exactly one thread may write and one thread may read.
+ */
+template <typename Value>
+class TripleBuffer
+{
+    public:
+        TripleBuffer() = default;
+        explicit TripleBuffer(const Value& initial) : buffers{initial, initial, initial} {};
+        TripleBuffer(const TripleBuffer&) = delete;
+        TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+        // writer side
+        Value& back() { return buffers[backIndex]; };
+        void publish() {
+            backIndex = middle.exchange(backIndex | freshBit, std::memory_order_acq_rel)
+                        & indexMask;
+        }
+
+        // reader side; update() returns false when nothing new was published
+        bool update() {
+            if (!(middle.load(std::memory_order_relaxed) & freshBit)) {
+                return false;
+            }
+            frontIndex = middle.exchange(frontIndex, std::memory_order_acq_rel) & indexMask;
+            return true;
+        }
+        const Value& front() const { return buffers[frontIndex]; };
+
+    private:
+        static constexpr unsigned indexMask = 3;
+        static constexpr unsigned freshBit = 4;
+
+        Value buffers[3];
+        std::atomic<unsigned> middle{1};
+        unsigned backIndex = 0;
+        unsigned frontIndex = 2;
+};
+
+} // utils
+
+#endif // __AI_TRIPLE_BUFFER_HPP__
@@ -13,10 +13,8 @@
 #include <vector>
 #include <numeric>
 #include <string>
-#include <fstream>
-#include <sstream>
-#include <iterator>
 #include <iostream>
+#include <new>
 
 namespace ai::utils {
 
@@ -27,20 +25,122 @@ using matrix = std::vector<std::vector<T>>;
 
 using verticies = std::vector<size_t>;
 
+/**
+ * Allocator returning cache line aligned storage, so
+ * SIMD kernels never straddle a line at the start of a buffer.
+ */
+constexpr auto cacheLineSize = size_t{64};
+
+template <typename T>
+struct AlignedAllocator
+{
+    using value_type = T;
+
+    AlignedAllocator() = default;
+    template <typename U>
+    constexpr AlignedAllocator(const AlignedAllocator<U>&) noexcept {}
+
+    T* allocate(size_t count) {
+        return static_cast<T*>(::operator new(count * sizeof(T),
+                                              std::align_val_t{cacheLineSize}));
+    }
+
+    void deallocate(T* pointer, size_t) noexcept {
+        ::operator delete(pointer, std::align_val_t{cacheLineSize});
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U>&) const noexcept { return true; }
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U>&) const noexcept { return false; }
+};
+
+template <typename T>
+using alignedVector = std::vector<T, AlignedAllocator<T>>;
+
+/**
+ * Non-owning view over a contiguous sequence.
+ * A minimal stand-in for std::span, which is not
+ * available in C++17.
+ */
+template <typename T>
+class span
+{
+    public:
+        constexpr span() = default;
+        constexpr span(T* data, size_t size) : first{data}, count{size} {};
+
+        constexpr T* begin() const { return first; };
+        constexpr T* end() const { return first + count; };
+        constexpr T* data() const { return first; };
+        constexpr T& operator[](size_t index) const { return first[index]; };
+        constexpr size_t size() const { return count; };
+        constexpr bool empty() const { return count == 0; };
+
+    private:
+        T* first = nullptr;
+        size_t count = 0;
+};
+
 constexpr auto e = 2.71828182845904523536;
 constexpr auto pi = 3.14159265358979323846;
 
 enum class FuncType {Sphere, Ackley, Griewank, Rastrigin, Rosenbrok};
 
-value_t spherefn(std::valarray<value_t>& args);
+/**
+ * Benchmark functions are templates over the scalar type.
+ * They are instantiated for float, double and long double
+ * in utils.cpp; long double is meant for validation runs.
+ */
+template <typename T>
+T spherefn(std::valarray<T>& args);
 
-value_t ackleyfn(std::valarray<value_t>& args);
+template <typename T>
+T ackleyfn(std::valarray<T>& args);
 
-value_t griewankfn(std::valarray<value_t>& args);
+template <typename T>
+T griewankfn(std::valarray<T>& args);
 
-value_t rastriginfn(std::valarray<value_t>& args);
+template <typename T>
+T rastriginfn(std::valarray<T>& args);
 
-value_t rosenbrokfn(std::valarray<value_t>& args);
+template <typename T>
+T rosenbrokfn(std::valarray<T>& args);
+
+/**
+ * Row-major block of points: point i occupies
+ * data[i * stride .. i * stride + dimensions).
+ */
+template <typename T>
+struct PointsView
+{
+    const T* data;
+    size_t count;
+    size_t dimensions;
+    size_t stride;
+
+    const T* operator[](size_t index) const { return data + index * stride; };
+};
+
+/**
+ * Batch versions of the benchmark functions. They write one
+ * value per point to results and are vectorized along each
+ * point with the widest lanes available (see simd.hpp).
+ */
+template <typename T>
+void sphereBatch(PointsView<T> points, T* results);
+
+template <typename T>
+void ackleyBatch(PointsView<T> points, T* results);
+
+template <typename T>
+void griewankBatch(PointsView<T> points, T* results);
+
+template <typename T>
+void rastriginBatch(PointsView<T> points, T* results);
+
+template <typename T>
+void rosenbrokBatch(PointsView<T> points, T* results);
 
 template <typename T>
 void print(T container) {
@@ -62,56 +162,8 @@ void print(T container) {
     std::cout << "]\n\n";
 }
 
-void prettyPrint(value_t min, std::valarray<value_t>& coordinates, FuncType type);
-
-/**
- * TODO: make parser safe
- *       to use.
- */
-class Parser
-{
-    public:
-        static matrix<size_t> getGraphFromFile(std::string filename)
-        {
-            std::ifstream inputData(filename);
-            std::istringstream tokenStream(filename);
-
-            auto split = [](auto line) {
-                std::istringstream iss(line);
-                std::vector<std::string> tokens = {std::istream_iterator<std::string> {iss},
-                                                    std::istream_iterator<std::string> {}};
-                return tokens;
-            };
-
-            auto graph = matrix<size_t>();
-            auto line = std::string{};
-            auto lineNumber = size_t{0};
-
-            if (inputData.is_open()) {
-                while (std::getline(inputData, line)) {
-                    if (line[0] == 'p') {
-                        auto tokens = split(line);
-                        auto graphSize = std::stoul(tokens[1]);
-
-                        for (size_t index = 0; index < graphSize; ++index) {
-                            graph.emplace_back(verticies(graphSize));
-                        }
-                    } else if (line[0] == 'i') {
-                        auto tokens = split(line);
-                        for (size_t column = 0; column < graph.size(); ++column) {
-                            graph[lineNumber][column] = std::stoul(tokens[column + 1]);
-                        }
-                        ++lineNumber;
-                    }
-                }
-            } else {
-                throw std::ios_base::failure("No file with given name.");
-            }
-
-            inputData.close();
-            return graph;
-        };
-};
+template <typename T>
+void prettyPrint(T min, std::valarray<T>& coordinates, FuncType type);
 
 } // utils
 
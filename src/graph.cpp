@@ -0,0 +1,306 @@
+/**
+ * file: graph.cpp
+ * synopsis: Implementation for the weighted graph
+ * author: Vladyslav Podilnyk
+ */
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include "graph.hpp"
+
+namespace ai {
+
+Graph::Graph(const utils::matrix<size_t>& wages, Storage storage)
+{
+    this->storage = storage;
+    verticiesCount = wages.size();
+
+    auto maxWeight = size_t{0};
+    auto edges = size_t{0};
+    for (const auto& row : wages) {
+        if (row.size() != verticiesCount) {
+            throw std::invalid_argument("Adjacency matrix must be square.");
+        }
+
+        for (auto weight : row) {
+            maxWeight = std::max(maxWeight, weight);
+            edges += weight != 0;
+        }
+    }
+
+    weightBytes = weightBytesFor(maxWeight);
+    ownedOffsets.reserve(verticiesCount + 1);
+    ownedNeighbours.reserve(edges);
+    ownedWeights.resize(edges * weightBytes);
+
+    for (const auto& row : wages) {
+        for (size_t column = 0; column < verticiesCount; ++column) {
+            if (row[column]) {
+                writeWeight(ownedWeights.data() + ownedNeighbours.size() * weightBytes,
+                            weightBytes, row[column]);
+                ownedNeighbours.push_back(column);
+            }
+        }
+        ownedOffsets.push_back(ownedNeighbours.size());
+    }
+    repoint();
+    buildDense();
+}
+
+Graph::Graph(std::vector<size_t> offsets, std::vector<size_t> neighbours,
+             std::vector<size_t> weights, Storage storage)
+{
+    this->storage = storage;
+    ownedOffsets = std::move(offsets);
+    ownedNeighbours = std::move(neighbours);
+    packWeights(weights);
+    repoint();
+
+    verify();
+    buildDense();
+}
+
+Graph::Graph(utils::span<const size_t> offsets, utils::span<const size_t> neighbours,
+             WeightsView weights, std::shared_ptr<const void> owner, Storage storage)
+{
+    this->storage = storage;
+    this->owner = std::move(owner);
+    this->offsets = offsets;
+    this->neighbours = neighbours;
+    this->weights = weights;
+    weightBytes = weights.bytes();
+    ownedOffsets.clear();
+    repoint();
+
+    // the dense matrix is filled from every row anyway
+    if (storage == Storage::Dense) {
+        verify();
+    } else {
+        validateOffsets();
+    }
+    buildDense();
+}
+
+Graph::Graph(const Graph& other)
+    : storage{other.storage}, verticiesCount{other.verticiesCount},
+      weightBytes{other.weightBytes}, dense{other.dense},
+      offsets{other.offsets}, neighbours{other.neighbours}, weights{other.weights},
+      ownedOffsets{other.ownedOffsets}, ownedNeighbours{other.ownedNeighbours},
+      ownedWeights{other.ownedWeights}, owner{other.owner}
+{
+    repoint();
+}
+
+Graph& Graph::operator=(const Graph& other)
+{
+    if (this != &other) {
+        auto copy = Graph(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+/**
+ * Points the CSR views at the owned vectors. Views of external
+ * memory are kept, unless that array has been copied locally.
+ */
+void Graph::repoint()
+{
+    auto view = [this](const std::vector<size_t>& owned, utils::span<const size_t>& array) {
+        if (!owner || !owned.empty()) {
+            array = {owned.data(), owned.size()};
+        }
+    };
+
+    view(ownedOffsets, offsets);
+    view(ownedNeighbours, neighbours);
+    if (!owner || !ownedWeights.empty()) {
+        weights = {ownedWeights.data(), ownedWeights.size() / weightBytes, weightBytes};
+    }
+    verticiesCount = offsets.empty() ? 0 : offsets.size() - 1;
+}
+
+void Graph::writeWeight(std::uint8_t* destination, size_t bytes, size_t value)
+{
+    auto store = [destination](auto narrow) {
+        std::memcpy(destination, &narrow, sizeof(narrow));
+    };
+
+    switch (bytes) {
+        case 1: store(static_cast<std::uint8_t>(value)); break;
+        case 2: store(static_cast<std::uint16_t>(value)); break;
+        case 4: store(static_cast<std::uint32_t>(value)); break;
+        default: store(static_cast<std::uint64_t>(value)); break;
+    }
+}
+
+void Graph::packWeights(const std::vector<size_t>& values)
+{
+    auto maxWeight = values.empty() ? size_t{0} : *std::max_element(begin(values), end(values));
+    weightBytes = weightBytesFor(maxWeight);
+    ownedWeights.resize(values.size() * weightBytes);
+    for (size_t index = 0; index < values.size(); ++index) {
+        writeWeight(ownedWeights.data() + index * weightBytes, weightBytes, values[index]);
+    }
+}
+
+/**
+ * Copies the weights into owned storage of the given width.
+ */
+void Graph::widenWeights(size_t bytes)
+{
+    auto widened = utils::alignedVector<std::uint8_t>(weights.size() * bytes);
+    for (size_t index = 0; index < weights.size(); ++index) {
+        writeWeight(widened.data() + index * bytes, bytes, weights[index]);
+    }
+
+    ownedWeights = std::move(widened);
+    weightBytes = bytes;
+    repoint();
+    buildDense();
+}
+
+/**
+ * O(V): row bounds only, reads neither neighbours nor weights.
+ */
+void Graph::validateOffsets() const
+{
+    if (offsets.empty() || offsets[0] != 0 || offsets[offsets.size() - 1] != neighbours.size()
+        || neighbours.size() != weights.size()) {
+        throw std::invalid_argument("Inconsistent CSR arrays.");
+    }
+
+    for (size_t vertex = 0; vertex < verticiesCount; ++vertex) {
+        if (offsets[vertex] > offsets[vertex + 1]) {
+            throw std::invalid_argument("CSR rows must be sorted and in range.");
+        }
+    }
+}
+
+/**
+ * O(E): every row and weight, see validateOffsets() for the rest.
+ */
+void Graph::verify() const
+{
+    validateOffsets();
+
+    for (size_t vertex = 0; vertex < verticiesCount; ++vertex) {
+        // strictly increasing, so no neighbour is listed twice
+        auto first = neighbours.begin() + offsets[vertex];
+        auto last = neighbours.begin() + offsets[vertex + 1];
+        if (std::adjacent_find(first, last, std::greater_equal<>{}) != last
+            || std::any_of(first, last, [this](auto node) { return node >= verticiesCount; })) {
+            throw std::invalid_argument("CSR rows must be strictly increasing and in range.");
+        }
+    }
+
+    // zero means "no edge" in the dense form
+    for (size_t edge = 0; edge < weights.size(); ++edge) {
+        if (!weights[edge]) {
+            throw std::invalid_argument("Edge weights must be positive.");
+        }
+    }
+}
+
+void Graph::buildDense()
+{
+    if (storage != Storage::Dense) {
+        return;
+    }
+
+    dense.assign(verticiesCount * verticiesCount * weightBytes, 0);
+    for (size_t vertex = 0; vertex < verticiesCount; ++vertex) {
+        for (auto edge = offsets[vertex]; edge < offsets[vertex + 1]; ++edge) {
+            auto cell = vertex * verticiesCount + neighbours[edge];
+            writeWeight(dense.data() + cell * weightBytes, weightBytes, weights[edge]);
+        }
+    }
+}
+
+size_t Graph::getPathWeight(utils::span<const size_t> path) const
+{
+    auto result = size_t{0};
+    for (size_t node = 0; node + 1 < path.size(); ++node) {
+        result += getWeight(path[node], path[node + 1]);
+    }
+    return result;
+}
+
+size_t Graph::getWeight(size_t startNode, size_t endNode) const
+{
+    if (storage == Storage::Dense) {
+        auto cell = startNode * verticiesCount + endNode;
+        return WeightsView(dense.data(), dense.size() / weightBytes, weightBytes)[cell];
+    }
+
+    auto edge = findEdge(startNode, endNode);
+    return edge ? weights[*edge] : 0;
+}
+
+size_t Graph::operator()(size_t startNode, size_t endNode) const
+{
+    return getWeight(startNode, endNode);
+}
+
+/**
+ * Returns the edge index of the updated edge.
+ */
+size_t Graph::setWeight(size_t startNode, size_t endNode, size_t weight)
+{
+    auto edge = findEdge(startNode, endNode);
+    if (!edge || !weight) {
+        throw std::invalid_argument("Only weights of existing edges can be changed.");
+    }
+
+    auto bytes = std::max(weightBytes, weightBytesFor(weight));
+    if (ownedWeights.empty() || bytes != weightBytes) {
+        widenWeights(bytes);
+    }
+
+    writeWeight(ownedWeights.data() + *edge * weightBytes, weightBytes, weight);
+    if (storage == Storage::Dense) {
+        auto cell = startNode * verticiesCount + endNode;
+        writeWeight(dense.data() + cell * weightBytes, weightBytes, weight);
+    }
+    return *edge;
+}
+
+utils::verticies Graph::getAdjacentVerticies(const size_t vertex) const
+{
+    auto row = getNeighbours(vertex);
+    return utils::verticies(row.begin(), row.end());
+}
+
+utils::span<const size_t> Graph::getNeighbours(size_t vertex) const
+{
+    return {neighbours.data() + offsets[vertex], offsets[vertex + 1] - offsets[vertex]};
+}
+
+WeightsView Graph::getNeighbourWeights(size_t vertex) const
+{
+    return weights.subview(offsets[vertex], offsets[vertex + 1] - offsets[vertex]);
+}
+
+size_t Graph::getMaxDegree() const
+{
+    auto result = size_t{0};
+    for (size_t vertex = 0; vertex < verticiesCount; ++vertex) {
+        result = std::max(result, offsets[vertex + 1] - offsets[vertex]);
+    }
+    return result;
+}
+
+std::optional<size_t> Graph::findEdge(size_t startNode, size_t endNode) const
+{
+    auto first = neighbours.begin() + offsets[startNode];
+    auto last = neighbours.begin() + offsets[startNode + 1];
+    auto found = std::lower_bound(first, last, endNode);
+
+    if (found == last || *found != endNode) {
+        return std::nullopt;
+    }
+    return static_cast<size_t>(found - neighbours.begin());
+}
+
+} // ai
@@ -0,0 +1,198 @@
+/**
+ * file: graphGenerator.cpp
+ * synopsis: Implementation for the random
+ *           graph generator
+ * author: Vladyslav Podilnyk
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include "graphGenerator.hpp"
+#include "randGen.hpp"
+
+namespace ai {
+
+namespace {
+
+using Row = std::vector<std::pair<size_t, size_t>>;
+
+class WeightSampler
+{
+    public:
+        WeightSampler(const GeneratorConfig& config, rgen::Xoshiro256& engine)
+            : config{config}, engine{engine} {};
+
+        size_t operator()() {
+            // a single allowed weight; the normal distribution would get a zero stddev
+            if (config.minWeight == config.maxWeight) {
+                return config.minWeight;
+            }
+
+            auto low = static_cast<double>(config.minWeight);
+            auto high = static_cast<double>(config.maxWeight);
+            auto value = low;
+
+            switch (config.distribution) {
+                case WeightDistribution::Uniform:
+                    value = low + rgen::canonical(engine) * (high - low + 1);
+                    break;
+                case WeightDistribution::Normal:
+                    value = std::normal_distribution<double>((low + high) / 2,
+                                                             (high - low) / 6)(engine);
+                    break;
+                case WeightDistribution::Exponential:
+                    value = low + std::exponential_distribution<double>(
+                                      4 / (high - low + 1))(engine);
+                    break;
+            }
+            return static_cast<size_t>(std::clamp(std::floor(value), low, high));
+        }
+
+    private:
+        const GeneratorConfig& config;
+        rgen::Xoshiro256& engine;
+};
+
+void validate(const GeneratorConfig& config)
+{
+    if (config.verticies < 2 || config.startPoint >= config.verticies
+        || config.endPoint >= config.verticies || config.startPoint == config.endPoint) {
+        throw std::invalid_argument("Start and end must be distinct verticies of the graph.");
+    }
+    if (!config.pathLength || config.pathLength >= config.verticies) {
+        throw std::invalid_argument("Path length must be within [1, verticies - 1].");
+    }
+    if (config.density < 0.0 || config.density > 1.0) {
+        throw std::invalid_argument("Density must be within [0, 1].");
+    }
+    if (!config.minWeight || config.minWeight > config.maxWeight) {
+        throw std::invalid_argument("Weights must satisfy 0 < minWeight <= maxWeight.");
+    }
+}
+
+/**
+ * startPoint, pathLength - 1 distinct random verticies, endPoint.
+ */
+utils::verticies plantPath(const GeneratorConfig& config, rgen::Xoshiro256& engine)
+{
+    auto others = utils::verticies();
+    others.reserve(config.verticies - 2);
+    for (size_t vertex = 0; vertex < config.verticies; ++vertex) {
+        if (vertex != config.startPoint && vertex != config.endPoint) {
+            others.push_back(vertex);
+        }
+    }
+
+    auto path = utils::verticies{config.startPoint};
+    for (size_t index = 0; index + 1 < config.pathLength; ++index) {
+        auto pick = index + engine() % (others.size() - index);
+        std::swap(others[index], others[pick]);
+        path.push_back(others[index]);
+    }
+    path.push_back(config.endPoint);
+    return path;
+}
+
+/**
+ * Random pairs of distinct verticies. Dense graphs test every
+ * pair, sparse ones draw the expected number of pairs directly.
+ */
+template <typename AddEdge>
+void addRandomEdges(const GeneratorConfig& config, rgen::Xoshiro256& engine, AddEdge addEdge)
+{
+    auto verticies = config.verticies;
+    if (config.density >= 0.05) {
+        for (size_t from = 0; from < verticies; ++from) {
+            for (auto to = from + 1; to < verticies; ++to) {
+                if (rgen::canonical(engine) < config.density) {
+                    addEdge(from, to);
+                }
+            }
+        }
+        return;
+    }
+
+    auto pairs = static_cast<double>(verticies) * (verticies - 1) / 2;
+    auto count = static_cast<size_t>(std::llround(pairs * config.density));
+    for (size_t edge = 0; edge < count; ++edge) {
+        auto from = engine() % verticies;
+        auto to = engine() % verticies;
+        if (from != to) {
+            addEdge(std::min(from, to), std::max(from, to));
+        }
+    }
+}
+
+} // namespace
+
+GeneratedGraph generateGraph(const GeneratorConfig& config)
+{
+    validate(config);
+
+    auto engine = rgen::Xoshiro256(config.seed);
+    auto sampleWeight = WeightSampler(config, engine);
+    auto rows = std::vector<Row>(config.verticies);
+
+    auto path = plantPath(config, engine);
+    auto pathWeights = utils::verticies();
+    for (size_t index = 0; index + 1 < path.size(); ++index) {
+        pathWeights.push_back(sampleWeight());
+    }
+    auto pathWeight = std::accumulate(begin(pathWeights), end(pathWeights), size_t{0});
+
+    // potentials: distance along the path, random for verticies off the path
+    auto potentials = std::vector<size_t>(config.verticies);
+    for (auto& potential : potentials) {
+        potential = engine() % (pathWeight + 1);
+    }
+    auto distance = size_t{0};
+    for (size_t index = 0; index < path.size(); ++index) {
+        potentials[path[index]] = distance;
+        distance += index < pathWeights.size() ? pathWeights[index] : 0;
+    }
+
+    addRandomEdges(config, engine, [&](size_t from, size_t to) {
+        auto weight = sampleWeight();
+        if (config.plantShortestPath) {
+            weight += std::max(potentials[from], potentials[to])
+                      - std::min(potentials[from], potentials[to]);
+        }
+        rows[from].emplace_back(to, weight);
+        rows[to].emplace_back(from, weight);
+    });
+
+    /**
+     * Planted edges go last, so after sorting by neighbour they
+     * win over a random edge drawn between the same verticies.
+     */
+    for (size_t index = 0; index + 1 < path.size(); ++index) {
+        rows[path[index]].emplace_back(path[index + 1], pathWeights[index]);
+        rows[path[index + 1]].emplace_back(path[index], pathWeights[index]);
+    }
+
+    auto offsets = std::vector<size_t>(1);
+    auto neighbours = std::vector<size_t>();
+    auto weights = std::vector<size_t>();
+    for (auto& row : rows) {
+        std::stable_sort(begin(row), end(row), [](auto& lhs, auto& rhs) {
+            return lhs.first < rhs.first;
+        });
+        for (size_t index = 0; index < row.size(); ++index) {
+            if (index + 1 < row.size() && row[index].first == row[index + 1].first) {
+                continue;
+            }
+            neighbours.push_back(row[index].first);
+            weights.push_back(row[index].second);
+        }
+        offsets.push_back(neighbours.size());
+        Row().swap(row);
+    }
+
+    return GeneratedGraph{Graph(std::move(offsets), std::move(neighbours), std::move(weights)),
+                          std::move(path), pathWeight};
+}
+
+} // ai
@@ -0,0 +1,364 @@
+/**
+ * file: graphLoader.cpp
+ * synopsis: Implementation for the .aco
+ *           graph loader
+ * author: Vladyslav Podilnyk
+ */
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include "graphLoader.hpp"
+#include "mappedFile.hpp"
+
+namespace ai {
+
+namespace {
+
+/**
+ * Walks a character range line by line and token by token
+ * without copying anything out of it.
+ */
+class AcoScanner
+{
+    public:
+        AcoScanner(const char* first, const char* last, const std::string& name)
+            : position{first}, last{last}, name{name} {};
+
+        bool nextLine() {
+            if (position == last) {
+                return false;
+            }
+
+            lineBegin = position;
+            auto newLine = static_cast<const char*>(std::memchr(position, '\n', last - position));
+            lineEnd = newLine ? newLine : last;
+            position = newLine ? newLine + 1 : last;
+            cursor = lineBegin;
+            ++lineNumber;
+            return true;
+        }
+
+        /**
+         * Consumes the record letter; '\0' for a blank line.
+         */
+        char recordType() {
+            skipSpaces();
+            if (cursor == lineEnd) {
+                return '\0';
+            }
+
+            auto type = *cursor++;
+            if (cursor != lineEnd && !isSpace(*cursor)) {
+                fail("unknown record type");
+            }
+            return type;
+        }
+
+        std::optional<size_t> nextNumber() {
+            skipSpaces();
+            if (cursor == lineEnd) {
+                return std::nullopt;
+            }
+
+            auto value = size_t{0};
+            auto [end, error] = std::from_chars(cursor, lineEnd, value);
+            if (error == std::errc::result_out_of_range) {
+                fail("number is out of range");
+            }
+            if (error != std::errc{} || (end != lineEnd && !isSpace(*end))) {
+                auto tokenEnd = cursor;
+                while (tokenEnd != lineEnd && !isSpace(*tokenEnd)) {
+                    ++tokenEnd;
+                }
+                fail("expected a non-negative integer, found '"
+                     + std::string(cursor, tokenEnd) + "'");
+            }
+
+            cursor = end;
+            return value;
+        }
+
+        [[noreturn]] void fail(const std::string& message) const {
+            throw std::invalid_argument(name + ":" + std::to_string(lineNumber) + ": " + message);
+        }
+
+    private:
+        static bool isSpace(char symbol) {
+            return symbol == ' ' || symbol == '\t' || symbol == '\r';
+        }
+
+        void skipSpaces() {
+            while (cursor != lineEnd && isSpace(*cursor)) {
+                ++cursor;
+            }
+        }
+
+        const char* position;
+        const char* last;
+        const char* lineBegin = nullptr;
+        const char* lineEnd = nullptr;
+        const char* cursor = nullptr;
+        size_t lineNumber = 0;
+        const std::string& name;
+};
+
+/**
+ * The binary format stores 64-bit little-endian integers, which
+ * can only be used in place on a matching host.
+ */
+constexpr bool isNativeBinaryLayout = __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+                                      && sizeof(size_t) == sizeof(std::uint64_t);
+
+void requireNativeBinaryLayout()
+{
+    if (!isNativeBinaryLayout) {
+        throw std::runtime_error("Binary graphs need a 64-bit little-endian host.");
+    }
+}
+
+size_t alignSection(size_t position)
+{
+    return (position + utils::cacheLineSize - 1) / utils::cacheLineSize * utils::cacheLineSize;
+}
+
+} // namespace
+
+Graph GraphLoader::fromAco(const std::string& filename, Graph::Storage storage)
+{
+    auto file = utils::MappedFile(filename);
+    return fromAco(file.data(), file.data() + file.size(), storage, filename);
+}
+
+Graph GraphLoader::fromAco(const char* first, const char* last, Graph::Storage storage,
+                           const std::string& name)
+{
+    auto scanner = AcoScanner(first, last, name);
+    auto verticiesCount = std::optional<size_t>{};
+    auto offsets = std::vector<size_t>(1);
+    auto neighbours = std::vector<size_t>();
+    auto weights = std::vector<size_t>();
+
+    while (scanner.nextLine()) {
+        switch (scanner.recordType()) {
+            case '\0':
+            case 'c':
+                break;
+
+            case 'p': {
+                if (verticiesCount) {
+                    scanner.fail("duplicate problem line");
+                }
+                verticiesCount = scanner.nextNumber();
+                if (!verticiesCount) {
+                    scanner.fail("problem line lacks the verticies count");
+                }
+                if (scanner.nextNumber()) {
+                    scanner.fail("unexpected value after the verticies count");
+                }
+                offsets.reserve(*verticiesCount + 1);
+                break;
+            }
+
+            case 'i': {
+                if (!verticiesCount) {
+                    scanner.fail("row given before the problem line");
+                }
+                if (offsets.size() > *verticiesCount) {
+                    scanner.fail("more than " + std::to_string(*verticiesCount) + " rows");
+                }
+
+                auto column = size_t{0};
+                while (auto weight = scanner.nextNumber()) {
+                    if (column == *verticiesCount) {
+                        scanner.fail("more than " + std::to_string(*verticiesCount) + " weights");
+                    }
+                    if (*weight) {
+                        neighbours.push_back(column);
+                        weights.push_back(*weight);
+                    }
+                    ++column;
+                }
+
+                if (column != *verticiesCount) {
+                    scanner.fail("expected " + std::to_string(*verticiesCount)
+                                 + " weights, found " + std::to_string(column));
+                }
+                offsets.push_back(neighbours.size());
+                break;
+            }
+
+            default:
+                scanner.fail("unknown record type");
+        }
+    }
+
+    if (!verticiesCount) {
+        scanner.fail("missing problem line");
+    }
+    if (offsets.size() - 1 != *verticiesCount) {
+        scanner.fail("expected " + std::to_string(*verticiesCount)
+                     + " rows, found " + std::to_string(offsets.size() - 1));
+    }
+
+    return Graph(std::move(offsets), std::move(neighbours), std::move(weights), storage);
+}
+
+Graph GraphLoader::fromBinary(const std::string& filename, Graph::Storage storage,
+                              bool verify)
+{
+    requireNativeBinaryLayout();
+
+    auto file = std::make_shared<utils::MappedFile>(filename);
+    auto fail = [&filename](const std::string& message) {
+        throw std::invalid_argument(filename + ": " + message);
+    };
+
+    auto header = BinaryGraphHeader{};
+    if (file->size() < sizeof(header)) {
+        fail("file is too short for a graph header");
+    }
+    std::memcpy(&header, file->data(), sizeof(header));
+
+    if (std::memcmp(header.magic, binaryGraphMagic, sizeof(header.magic)) != 0) {
+        fail("not a binary graph file");
+    }
+    if (header.version != binaryGraphVersion) {
+        fail("unsupported format version " + std::to_string(header.version));
+    }
+    auto width = header.weightBytes;
+    if (width != 1 && width != 2 && width != 4 && width != 8) {
+        fail("unsupported weight size " + std::to_string(header.weightBytes));
+    }
+
+    auto section = [&](std::uint64_t position, std::uint64_t count, size_t bytes,
+                       const char* name) {
+        if (position % bytes || position > file->size()
+            || count > (file->size() - position) / bytes) {
+            fail(std::string(name) + " section is out of the file");
+        }
+        return file->data() + position;
+    };
+
+    if (header.verticiesCount >= file->size()) {
+        fail("offsets section is out of the file");
+    }
+    auto offsets = section(header.offsetsSection, header.verticiesCount + 1,
+                           sizeof(size_t), "offsets");
+    auto neighbours = section(header.neighboursSection, header.edgesCount,
+                              sizeof(size_t), "neighbours");
+    auto weights = section(header.weightsSection, header.edgesCount,
+                           header.weightBytes, "weights");
+
+    auto graph = Graph({reinterpret_cast<const size_t*>(offsets), header.verticiesCount + 1},
+                       {reinterpret_cast<const size_t*>(neighbours), header.edgesCount},
+                       WeightsView(weights, header.edgesCount, header.weightBytes),
+                       std::move(file), storage);
+    if (verify) {
+        graph.verify();
+    }
+    return graph;
+}
+
+void GraphLoader::toBinary(const Graph& graph, const std::string& filename)
+{
+    requireNativeBinaryLayout();
+
+    auto header = BinaryGraphHeader{};
+    std::memcpy(header.magic, binaryGraphMagic, sizeof(header.magic));
+    header.version = binaryGraphVersion;
+    header.weightBytes = static_cast<std::uint32_t>(graph.getWeightBytes());
+    header.verticiesCount = graph.size();
+    header.edgesCount = graph.edgesCount();
+    header.offsetsSection = alignSection(sizeof(header));
+    header.neighboursSection = alignSection(header.offsetsSection
+                                            + (graph.size() + 1) * sizeof(size_t));
+    header.weightsSection = alignSection(header.neighboursSection
+                                         + graph.edgesCount() * sizeof(size_t));
+
+    auto output = std::ofstream(filename, std::ios::binary | std::ios::trunc);
+    if (!output) {
+        throw std::ios_base::failure("Can not create file: " + filename);
+    }
+
+    auto write = [&output](const void* data, size_t bytes) {
+        output.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+    };
+    auto padTo = [&](std::uint64_t position) {
+        static const char zeros[utils::cacheLineSize] = {};
+        write(zeros, position - static_cast<std::uint64_t>(output.tellp()));
+    };
+
+    write(&header, sizeof(header));
+    padTo(header.offsetsSection);
+    for (size_t vertex = 0; vertex <= graph.size(); ++vertex) {
+        auto offset = graph.getEdgeOffset(vertex);
+        write(&offset, sizeof(offset));
+    }
+
+    padTo(header.neighboursSection);
+    for (size_t vertex = 0; vertex < graph.size(); ++vertex) {
+        auto row = graph.getNeighbours(vertex);
+        write(row.data(), row.size() * sizeof(size_t));
+    }
+
+    padTo(header.weightsSection);
+    for (size_t vertex = 0; vertex < graph.size(); ++vertex) {
+        auto row = graph.getNeighbourWeights(vertex);
+        write(row.data(), row.size() * row.bytes());
+    }
+
+    if (!output.flush()) {
+        throw std::ios_base::failure("Can not write file: " + filename);
+    }
+}
+
+void GraphLoader::toAco(const Graph& graph, const std::string& filename,
+                        const std::string& comment)
+{
+    auto output = std::ofstream(filename, std::ios::trunc);
+    if (!output) {
+        throw std::ios_base::failure("Can not create file: " + filename);
+    }
+
+    for (size_t first = 0; first < comment.size();) {
+        auto last = std::min(comment.find('\n', first), comment.size());
+        output << "c " << comment.substr(first, last - first) << "\n";
+        first = last + 1;
+    }
+    output << "p " << graph.size() << "\n";
+
+    /**
+     * Dense rows make the file quadratic in the verticies count,
+     * so every row is formatted into one buffer with std::to_chars.
+     */
+    auto line = std::string();
+    for (size_t vertex = 0; vertex < graph.size(); ++vertex) {
+        auto neighbours = graph.getNeighbours(vertex);
+        auto weights = graph.getNeighbourWeights(vertex);
+
+        line.assign("i");
+        auto edge = size_t{0};
+        char number[24] = {' '};
+        for (size_t column = 0; column < graph.size(); ++column) {
+            auto weight = size_t{0};
+            if (edge < neighbours.size() && neighbours[edge] == column) {
+                weight = weights[edge++];
+            }
+            auto end = std::to_chars(number + 1, std::end(number), weight).ptr;
+            line.append(number, end);
+        }
+        line.push_back('\n');
+        output.write(line.data(), static_cast<std::streamsize>(line.size()));
+    }
+
+    if (!output.flush()) {
+        throw std::ios_base::failure("Can not write file: " + filename);
+    }
+}
+
+} // ai
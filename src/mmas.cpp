@@ -4,269 +4,734 @@
  * author: Vladyslav Podilnyk
  */
 
+#include <atomic>
+#include <future>
 #include <limits>
 #include <algorithm>
+#include <stdexcept>
+#include <iterator>
+#include <numeric>
 #include "mmas.hpp"
-#include "randGen.hpp"
+#include "simd.hpp"
 
 namespace ai {
 
 /**
- * Implementation for Graph class
+ * Implementation for Aco class
  */
-size_t Graph::getPathWeight(const utils::verticies& path)
+Aco::Aco(const Graph& graph, const AntSystemConfig& config)
 {
-    auto result = size_t{0};
-    for (size_t node = 0; node < path.size() - 1; ++node) {
-        result += getWeight(path[node], path[node + 1]);
+    this->graph = graph;
+    this->config = config;
+
+    /**
+     * pheromones, heuristic and choiceInfo are indexed by edge,
+     * in the order of the graph's CSR arrays, so missing edges
+     * cost neither memory nor evaporation time.
+     *
+     * The graph is undirected when every edge has a reverse edge of
+     * the same weight; only then are pheromones and weight updates
+     * mirrored, otherwise reverseEdges is dropped.
+     */
+    reverseEdges.resize(graph.edgesCount());
+    heuristic.resize(graph.edgesCount());
+    for (size_t vertex = 0; vertex < graph.size(); ++vertex) {
+        auto weights = graph.getNeighbourWeights(vertex);
+        auto offset = graph.getEdgeOffset(vertex);
+        auto adjacentVerticies = graph.getNeighbours(vertex);
+        for (size_t index = 0; index < weights.size(); ++index) {
+            heuristic[offset + index] = 1.0 / std::pow(weights[index], this->config.beta);
+            auto next = adjacentVerticies[index];
+            auto reverse = graph.findEdge(next, vertex);
+            undirected = undirected && reverse
+                         && graph.getNeighbourWeights(next)[*reverse - graph.getEdgeOffset(next)]
+                            == weights[index];
+            reverseEdges[offset + index] = reverse.value_or(noEdge);
+        }
+    }
+    if (!undirected) {
+        std::vector<size_t>().swap(reverseEdges);
+    }
+
+    if (this->config.candidateListSize) {
+        buildCandidateLists();
+    }
+
+    if (this->config.pheromoneBlend < 0.0 || this->config.pheromoneBlend > 1.0) {
+        throw std::invalid_argument("Pheromone blend must be within [0, 1].");
+    }
+
+    seed = this->config.seed ? *this->config.seed : rgen::makeSeed();
+
+    auto threads = std::max<size_t>(this->config.numberOfThreads, 1);
+    if (threads > 1) {
+        threadPool = std::make_shared<ThreadPool>(threads);
     }
-    return result;
 }
 
-size_t Graph::getWeight(size_t startNode, size_t endNode)
+/**
+ * Puts the colony in the initial state for a query. Buffers
+ * keep their capacity, so reusing a colony does not allocate.
+ */
+void Aco::resetColony(Colony& colony, const Query& query, size_t workers,
+                      std::uint64_t seed)
 {
-    return paths[startNode][endNode]; 
+    if (query.first >= graph.size() || query.second >= graph.size()) {
+        throw std::invalid_argument("Query vertex is out of the graph.");
+    }
+
+    colony.startPoint = query.first;
+    colony.endPoint = query.second;
+    colony.pheromones.assign(graph.edgesCount(), config.initPheromoneLevel);
+    colony.choiceInfo.resize(graph.edgesCount());
+    colony.shortestPath.clear();
+    colony.shortestEdges.clear();
+    colony.bestPathWeight = std::numeric_limits<size_t>::max();
+    colony.maxPheromoneLevel = std::numeric_limits<double>::max();
+    colony.minPheromoneLevel = 0.0;
+    colony.stats = SolveStats{};
+    colony.termination = Termination(config.termination);
+
+    auto maxDegree = graph.getMaxDegree();
+    colony.antWorkers.resize(workers);
+    for (auto& worker : colony.antWorkers) {
+        worker.engine = rgen::RandGen<>(rgen::splitMix64(seed));
+        worker.route.reserve(config.maxAntMoves + 1);
+        worker.routeEdges.reserve(config.maxAntMoves + 1);
+        worker.visited.assign(graph.size(), 0);
+        worker.epoch = 0;
+        worker.candidates.reserve(maxDegree);
+        worker.probabilities.reserve(maxDegree);
+    }
 }
 
-size_t Graph::operator()(size_t startNode, size_t endNode)
+bool Aco::isRouteCompleted(const Colony& colony, const utils::verticies& route)
 {
-    return paths[startNode][endNode];
+    return route.front() == colony.startPoint && route.back() == colony.endPoint;
 }
 
-utils::verticies Graph::getAdjacentVerticies(const size_t vertex)
+/**
+ * Candidate list of a vertex holds positions (within its CSR row)
+ * of its candidateListSize cheapest outgoing edges, cheapest first.
+ */
+void Aco::buildCandidateLists()
 {
-    auto result = std::vector<size_t>{};
-    for (size_t column = 0; column < paths.size(); ++column) {
-        if (paths[vertex][column]) {
-            result.push_back(column);
-        }
+    candidateOffsets.assign(1, 0);
+    for (size_t vertex = 0; vertex < graph.size(); ++vertex) {
+        auto listSize = std::min(config.candidateListSize, graph.getNeighbours(vertex).size());
+        candidateOffsets.push_back(candidateOffsets.back() + listSize);
     }
-    return result;
-}
 
+    candidateLists.resize(candidateOffsets.back());
+    for (size_t vertex = 0; vertex < graph.size(); ++vertex) {
+        sortCandidates(vertex, candidateLists.data() + candidateOffsets[vertex]);
+    }
+}
 
 /**
- * Implementation for Aco class
+ * Writes the candidate list of vertex to candidates, which
+ * has room for candidateOffsets[vertex + 1] - candidateOffsets[vertex]
+ * entries.
  */
-Aco::Aco(const Graph& graph, const AntSystemConfig& config)
+void Aco::sortCandidates(size_t vertex, size_t* candidates)
 {
-    this->graph = graph;
-    this->config = config;
-
-    startPoint = 0;
-    endPoint = 0;
-    countDown = iterationsBeforeComplete;
-
-    shortestPath = std::vector<size_t>{};
-    bestPathWeight = std::numeric_limits<size_t>::max();
-
-    for (size_t line = 0; line < graph.size(); ++line) {
-        auto vect = std::vector<double>(graph.size());
-        std::fill(begin(vect), end(vect), this->config.initPheromoneLevel);
-        pheromones.emplace_back(vect);
-    }
+    auto weights = graph.getNeighbourWeights(vertex);
+    auto listSize = candidateOffsets[vertex + 1] - candidateOffsets[vertex];
+    auto row = utils::verticies(weights.size());
+
+    std::iota(begin(row), end(row), size_t{0});
+    std::partial_sort(begin(row), begin(row) + listSize, end(row),
+                      [&weights](auto lhs, auto rhs) { return weights[lhs] < weights[rhs]; });
+    std::copy(begin(row), begin(row) + listSize, candidates);
 }
 
-bool Aco::isRouteCompleted(const utils::verticies& route)
+void Aco::startWalk(Colony& colony, AntWorker& worker)
 {
-    return route.front() == startPoint && route.back() == endPoint;
+    if (++worker.epoch == 0) {
+        std::fill(begin(worker.visited), end(worker.visited), 0);
+        worker.epoch = 1;
+    }
+
+    worker.route.clear();
+    worker.route.push_back(colony.startPoint);
+    worker.routeEdges.assign(1, noEdge);
+    worker.routeWeight = 0;
+    worker.visited[colony.startPoint] = worker.epoch;
 }
 
-std::vector<double> Aco::calculateProbabilities(const size_t vertex,
-                                        utils::verticies& adjacentVerticies)
+/**
+ * Roulette wheel selection over unvisited neighbours,
+ * weighted by the choice info of their edges. With candidate
+ * lists only the nearest neighbours are considered, unless all
+ * of them are visited already. Returns the position of the
+ * chosen edge within the CSR row of the current vertex.
+ */
+std::optional<size_t> Aco::getNextEdge(const Colony& colony, AntWorker& worker)
 {
-    auto result = std::vector<double>{};
+    auto vertex = worker.route.back();
+    auto adjacentVerticies = graph.getNeighbours(vertex);
+    auto edgeChoiceInfo = colony.choiceInfo.data() + graph.getEdgeOffset(vertex);
+    auto& candidates = worker.candidates;
+    auto& probabilities = worker.probabilities;
     auto sum = 0.0;
 
-    for (const auto& value : adjacentVerticies) {
-        auto probability = std::pow(pheromones[vertex][value], config.alpha)
-                            / std::pow(graph(vertex, value), config.beta);
-        sum += probability;
-        result.emplace_back(probability);
-    }
+    auto consider = [&](size_t index) {
+        if (worker.visited[adjacentVerticies[index]] != worker.epoch) {
+            sum += edgeChoiceInfo[index];
+            candidates.push_back(index);
+            probabilities.push_back(edgeChoiceInfo[index]);
+        }
+    };
 
-    for (auto& value : result) {
-        value /= sum;
+    candidates.clear();
+    probabilities.clear();
+    if (!candidateLists.empty()) {
+        for (auto index = candidateOffsets[vertex]; index < candidateOffsets[vertex + 1]; ++index) {
+            consider(candidateLists[index]);
+        }
     }
 
-    return result;
-}
-
-std::optional<size_t> Aco::getNextVertex(const utils::verticies& route)
-{
-    auto adjacentVerticies = graph.getAdjacentVerticies(route.back());
-    auto filteredVerticies = filterVisitedVerticies(route, adjacentVerticies);
+    if (candidates.empty()) {
+        for (size_t index = 0; index < adjacentVerticies.size(); ++index) {
+            consider(index);
+        }
+    }
 
-    if (!filteredVerticies.size()) {
+    if (candidates.empty()) {
         return std::nullopt;
     }
 
-    auto probabilities = calculateProbabilities(route.back(), filteredVerticies);
+    auto randValue = worker.engine.canonical() * sum;
     auto total = 0.0;
-    auto randValue = rgen::RandGen<double>(std::make_pair(0.0, 1.0)).randValue();
 
-    for (size_t index = 0; index < filteredVerticies.size(); ++index) {
+    for (size_t index = 0; index < candidates.size(); ++index) {
         total += probabilities[index];
         if (total > randValue) {
-            return filteredVerticies[index];
+            return candidates[index];
         }
     }
 
     /**
-     * In case we didn't choose any vertex,
-     * which is bad, just pick random vertex
-     * from the list.
+     * Rounding may leave the running total just below
+     * randValue, in which case the last candidate wins.
      */
-    auto randIndex = rgen::RandGen<size_t, std::uniform_int_distribution<size_t>>(
-                            std::make_pair(0, filteredVerticies.size() - 1)).randValue();
-    return filteredVerticies[randIndex];
+    return candidates.back();
 }
 
-utils::matrix<size_t> Aco::constructSolutions()
+void Aco::walkAnt(Colony& colony, AntWorker& worker)
 {
-    auto finishedPathes = utils::matrix<size_t>{};
-    auto routes = utils::matrix<size_t>(config.numberOfAnts);
-    for (auto& route : routes) {
-        route.push_back(startPoint);
-    }
+    auto& route = worker.route;
+    startWalk(colony, worker);
 
     for (size_t iter = 0; iter < config.maxAntMoves; ++iter) {
-        for (auto& route : routes) {
-            if (isRouteCompleted(route)) {
-                continue;
-            }
+        if (isRouteCompleted(colony, route)) {
+            return;
+        }
 
-            auto next = getNextVertex(route);
-            if (next) {
-                route.push_back(*next);
-                if (route.back() == endPoint) {
-                    finishedPathes.push_back(route);
-                }
+        auto vertex = route.back();
+        auto edge = getNextEdge(colony, worker);
+        if (!edge) {
+            if constexpr (utils::instrumentation) {
+                ++worker.deadEnds;
             }
+            return;
+        }
+
+        auto next = graph.getNeighbours(vertex)[*edge];
+        worker.routeWeight += graph.getNeighbourWeights(vertex)[*edge];
+        ++worker.steps;
+        route.push_back(next);
+        worker.routeEdges.back() = graph.getEdgeOffset(vertex) + *edge;
+        worker.routeEdges.push_back(noEdge);
+        worker.visited[next] = worker.epoch;
+        if (next == colony.endPoint) {
+            worker.finishedRoutes.push({route.data(), route.size()},
+                                       {worker.routeEdges.data(), worker.routeEdges.size()},
+                                       worker.routeWeight);
         }
     }
-    return finishedPathes;
 }
 
-std::pair<size_t, utils::verticies> Aco::findBest(const utils::matrix<size_t>& routes)
+/**
+ * Ants only read pheromones while building their routes,
+ * so they are spread over the thread pool without locking.
+ * Finished routes are merged in worker order, which keeps
+ * the result independent of thread scheduling.
+ */
+const Routes& Aco::constructSolutions(Colony& colony, ThreadPool* pool)
 {
-    auto min = graph.getPathWeight(routes[0]);
-    auto best = size_t{0};
-
-    for (size_t index = 1; index < routes.size(); ++index) {
-        auto pathWeight = graph.getPathWeight(routes[index]);
-        if (pathWeight < min) {
-            min = pathWeight;
-            best = index;
+    auto walkAnts = [this, &colony](size_t first, size_t last, size_t workerId) {
+        auto& worker = colony.antWorkers[workerId];
+        for (size_t ant = first; ant < last; ++ant) {
+            walkAnt(colony, worker);
         }
+    };
+
+    for (auto& worker : colony.antWorkers) {
+        worker.finishedRoutes.clear();
     }
 
-    return std::make_pair(min, routes[best]);
+    if (pool) {
+        pool->parallelFor(config.numberOfAnts, walkAnts);
+    } else {
+        walkAnts(0, config.numberOfAnts, 0);
+    }
+
+    colony.solutions.clear();
+    for (auto& worker : colony.antWorkers) {
+        colony.solutions.append(worker.finishedRoutes);
+        colony.stats.antSteps += worker.steps;
+        colony.stats.deadEndAnts += worker.deadEnds;
+        worker.steps = 0;
+        worker.deadEnds = 0;
+    }
+    return colony.solutions;
 }
 
-double Aco::getMaxPheromoneLevel()
+std::pair<size_t, size_t> Aco::findBest(const Routes& routes)
 {
-    return (1.0 / (1 - config.p)) * (1.0 / graph.getPathWeight(shortestPath));
+    auto best = std::min_element(begin(routes.weights), end(routes.weights));
+    return std::make_pair(*best, std::distance(begin(routes.weights), best));
 }
 
-double Aco::getMinPheromoneLevel()
+/**
+ * tau-max and tau-min only depend on the best-so-far weight,
+ * so they are refreshed when it improves rather than per use.
+ */
+void Aco::updatePheromoneLimits(Colony& colony)
 {
-    return getMaxPheromoneLevel() / config.alpha;
+    colony.maxPheromoneLevel = (1.0 / (1 - config.p)) * (1.0 / colony.bestPathWeight);
+    colony.minPheromoneLevel = colony.maxPheromoneLevel / config.alpha;
 }
 
-double Aco::getPheromone(size_t startPoint, size_t endPoint)
+bool Aco::isFinished(Colony& colony)
 {
-    return pheromones[startPoint][endPoint];
+    auto& stats = colony.stats;
+    if (isCancelled()) {
+        stats.stopReason = StopReason::Cancelled;
+        return true;
+    }
+    if (!colony.termination(stats.iterations, stats.antSteps,
+                            static_cast<double>(colony.bestPathWeight))) {
+        return false;
+    }
+
+    stats.stopReason = colony.termination.getReason();
+    return true;
 }
 
-void Aco::setPheromone(size_t startPoint, size_t endPoint, double value)
+void Aco::updatePheromoneLevel(Colony& colony, const Routes& routes)
 {
-    pheromones[startPoint][endPoint] = value;
+    if (routes.empty()) {
+        return;
+    }
+
+    auto [currBestWeight, currBest] = findBest(routes);
+    if (currBestWeight < colony.bestPathWeight) {
+        colony.shortestPath.assign(routes[currBest].begin(), routes[currBest].end());
+        colony.shortestEdges.assign(routes.edgesOf(currBest).begin(),
+                                    routes.edgesOf(currBest).end());
+        colony.bestPathWeight = currBestWeight;
+        updatePheromoneLimits(colony);
+    }
+
+    auto& pheromones = colony.pheromones;
+    auto maxPheromoneLevel = colony.maxPheromoneLevel;
+
+    for (size_t routeIndex = 0; routeIndex < routes.size(); ++routeIndex) {
+        auto edges = routes.edgesOf(routeIndex);
+        auto delta = Q / routes.weights[routeIndex];
+        for (size_t index = 0; index + 1 < edges.size(); ++index) {
+            auto edge = edges[index];
+            auto newVal = std::min(pheromones[edge] + delta, maxPheromoneLevel);
+
+            pheromones[edge] = newVal;
+            if (undirected) {
+                pheromones[reverseEdges[edge]] = newVal;
+            }
+        }
+    }
 }
 
-utils::verticies Aco::filterVisitedVerticies(const utils::verticies& route,
-                                        const utils::verticies& adjacentVerticies)
+void Aco::evaporate(Colony& colony)
 {
-    auto result = utils::verticies{};
+    if (!colony.shortestPath.size()) {
+        return;
+    }
+
+    auto decay = 1 - config.p;
+    auto minPheromoneLevel = colony.minPheromoneLevel;
 
-    for (auto& value : adjacentVerticies) {
-        auto searchedElement = std::find(begin(route), end(route), value);
-        if (searchedElement == end(route)) {
-            result.push_back(value);
+    simd::transform(colony.pheromones.data(), colony.pheromones.size(), [=](auto lanes, auto value) {
+        return lanes.max(lanes.mul(value, lanes.set(decay)), lanes.set(minPheromoneLevel));
+    });
+}
+
+/**
+ * choiceInfo = tau^alpha * (1 / weight)^beta for every edge.
+ * Pheromones only change between iterations, so this is the
+ * only place std::pow is called in the main loop.
+ */
+void Aco::updateChoiceInfo(Colony& colony, ThreadPool* pool)
+{
+    auto refreshRows = [this, &colony](size_t first, size_t last, size_t) {
+        for (size_t vertex = first; vertex < last; ++vertex) {
+            auto adjacentVerticies = graph.getNeighbours(vertex);
+            auto offset = graph.getEdgeOffset(vertex);
+            for (size_t index = 0; index < adjacentVerticies.size(); ++index) {
+                colony.choiceInfo[offset + index] = heuristic[offset + index]
+                    * std::pow(colony.pheromones[offset + index], config.alpha);
+            }
         }
+    };
+
+    if (pool) {
+        pool->parallelFor(graph.size(), refreshRows);
+    } else {
+        refreshRows(0, graph.size(), 0);
     }
-    return result;
 }
 
-bool Aco::isFinished()
+void Aco::iterate(Colony& colony, ThreadPool* pool)
 {
-    return --countDown == 0;
+    auto& stats = colony.stats;
+    {
+        auto timer = utils::PhaseTimer(stats.constructSeconds);
+        constructSolutions(colony, pool);
+    }
+    {
+        auto timer = utils::PhaseTimer(stats.pheromoneUpdateSeconds);
+        updatePheromoneLevel(colony, colony.solutions);
+    }
+    {
+        auto timer = utils::PhaseTimer(stats.evaporateSeconds);
+        evaporate(colony);
+    }
+    {
+        auto timer = utils::PhaseTimer(stats.choiceInfoSeconds);
+        updateChoiceInfo(colony, pool);
+    }
+    ++stats.iterations;
+    stats.bestPathWeight = colony.bestPathWeight;
 }
 
-void Aco::updatePheromoneLevel(utils::matrix<size_t>& routes)
+/**
+ * The termination check starts here, so limits count from
+ * the start of this solve even for a resumed colony.
+ */
+utils::verticies Aco::solve(Colony& colony, ThreadPool* pool, bool report)
 {
-    if (!routes.size()) {
-        return;
+    colony.termination.start(colony.stats.iterations, colony.stats.antSteps,
+                             static_cast<double>(colony.bestPathWeight));
+    updateChoiceInfo(colony, pool);
+    while (!isFinished(colony)) {
+        iterate(colony, pool);
+        if (report) {
+            reportStats(colony.stats);
+            publishBest(colony);
+        }
     }
 
-    auto [currBestWeight, currBestRoute] = findBest(routes);
-    if (currBestWeight < bestPathWeight) {
-        shortestPath = currBestRoute;
-        bestPathWeight = currBestWeight;
-        countDown = iterationsBeforeComplete;
+    return colony.shortestPath;
+}
+
+/**
+ * Islands only touch their own colony between exchanges, so an
+ * epoch needs no locking. Exchanges run on the calling thread in
+ * island order, which keeps the result independent of the number
+ * of threads. The termination policy sees the best route of all
+ * islands and the work of all of them; the winning island then
+ * becomes the colony used by reoptimize().
+ */
+utils::verticies Aco::solveIslands(const Query& query)
+{
+    islandColonies.resize(config.islands);
+    for (auto& island : islandColonies) {
+        resetColony(island, query, 1, rgen::splitMix64(seed));
     }
+    reportStats.reset();
+
+    auto termination = Termination(config.termination);
+    termination.start();
+
+    auto interval = std::max<size_t>(config.exchangeInterval, 1);
+    auto runEpoch = [this, interval, &termination](size_t first, size_t last, size_t) {
+        for (auto index = first; index < last; ++index) {
+            auto& island = islandColonies[index];
+            updateChoiceInfo(island, nullptr);
+            for (size_t iteration = 0;
+                 iteration < interval && !termination.isOverdue() && !isCancelled();
+                 ++iteration) {
+                iterate(island, nullptr);
+            }
+        }
+    };
+
+    auto byWeight = [](const Colony& lhs, const Colony& rhs) {
+        return lhs.bestPathWeight < rhs.bestPathWeight;
+    };
+
+    // an epoch cut short by the time limit or a cancel counts only what ran
+    auto sumStats = [this]() {
+        auto total = SolveStats{};
+        for (const auto& island : islandColonies) {
+            total.iterations = std::max(total.iterations, island.stats.iterations);
+            total.antSteps += island.stats.antSteps;
+            total.deadEndAnts += island.stats.deadEndAnts;
+            total.bestPathWeight = std::min(total.bestPathWeight, island.bestPathWeight);
+            total.constructSeconds += island.stats.constructSeconds;
+            total.pheromoneUpdateSeconds += island.stats.pheromoneUpdateSeconds;
+            total.evaporateSeconds += island.stats.evaporateSeconds;
+            total.choiceInfoSeconds += island.stats.choiceInfoSeconds;
+        }
+        return total;
+    };
+
+    auto stats = sumStats();
+    while (!isCancelled() && !termination(stats.iterations, stats.antSteps,
+                                          static_cast<double>(stats.bestPathWeight))) {
+        if (threadPool) {
+            threadPool->parallelFor(islandColonies.size(), runEpoch);
+        } else {
+            runEpoch(0, islandColonies.size(), 0);
+        }
 
-    auto maxPheromoneLevel = getMaxPheromoneLevel();
+        exchangeBestRoutes();
+        if (config.pheromoneBlend > 0.0) {
+            blendPheromones();
+        }
 
-    for (const auto& route : routes) {
-        auto delta = Q / graph.getPathWeight(route);
-        for (size_t index = 0; index < route.size() - 1; ++index) {
-            auto newVal = getPheromone(route[index], route[index + 1]) + delta;
+        stats = sumStats();
+        reportStats(stats);
 
-            if (newVal < maxPheromoneLevel) {
-                setPheromone(route[index], route[index + 1], newVal);
-                setPheromone(route[index + 1], route[index], newVal);
-            } else {
-                setPheromone(route[index], route[index + 1], maxPheromoneLevel);
-                setPheromone(route[index + 1], route[index], maxPheromoneLevel);
-            }
+        auto best = std::min_element(begin(islandColonies), end(islandColonies), byWeight);
+        publishBest(*best);
+    }
+
+    stats.stopReason = isCancelled() ? StopReason::Cancelled : termination.getReason();
+    auto best = std::min_element(begin(islandColonies), end(islandColonies), byWeight);
+    std::swap(colony, *best);
+    colony.stats = stats;
+    return colony.shortestPath;
+}
+
+/**
+ * Every island receives the best route of its source, snapshotted
+ * before any island changes, and treats it like a route of its own
+ * ants: it becomes the island's best if it is better and it gets
+ * a pheromone deposit either way.
+ */
+void Aco::exchangeBestRoutes()
+{
+    auto islands = islandColonies.size();
+
+    migrants.clear();
+    for (const auto& island : islandColonies) {
+        migrants.push({island.shortestPath.data(), island.shortestPath.size()},
+                      {island.shortestEdges.data(), island.shortestEdges.size()},
+                      island.bestPathWeight);
+    }
+
+    auto globalBest = static_cast<size_t>(std::distance(begin(migrants.weights),
+        std::min_element(begin(migrants.weights), end(migrants.weights))));
+
+    for (size_t index = 0; index < islands; ++index) {
+        auto source = config.topology == IslandTopology::Ring
+                      ? (index + islands - 1) % islands
+                      : globalBest;
+        if (source == index || migrants[source].empty()) {
+            continue;
         }
+
+        incoming.clear();
+        incoming.push(migrants[source], migrants.edgesOf(source), migrants.weights[source]);
+        updatePheromoneLevel(islandColonies[index], incoming);
     }
 }
 
-void Aco::evaporate()
+/**
+ * tau = (1 - blend) * tau + blend * tau', where tau' is the
+ * pheromone of the ring predecessor or, when fully connected,
+ * the mean over all islands.
+ */
+void Aco::blendPheromones()
 {
-    if (!shortestPath.size()) {
+    auto islands = islandColonies.size();
+    auto blend = config.pheromoneBlend;
+    auto mix = [blend](utils::alignedVector<double>& target, const double* source) {
+        for (size_t edge = 0; edge < target.size(); ++edge) {
+            target[edge] = (1 - blend) * target[edge] + blend * source[edge];
+        }
+    };
+
+    if (config.topology == IslandTopology::Ring) {
+        // walk backwards so every island still reads its predecessor's old values
+        blendBuffer = islandColonies.back().pheromones;
+        for (auto index = islands; index-- > 0;) {
+            auto source = index ? islandColonies[index - 1].pheromones.data()
+                                : blendBuffer.data();
+            mix(islandColonies[index].pheromones, source);
+        }
         return;
     }
 
-    auto minPheromoneLevel = getMinPheromoneLevel();
+    blendBuffer.assign(graph.edgesCount(), 0.0);
+    for (const auto& island : islandColonies) {
+        for (size_t edge = 0; edge < blendBuffer.size(); ++edge) {
+            blendBuffer[edge] += island.pheromones[edge] / islands;
+        }
+    }
+    for (auto& island : islandColonies) {
+        mix(island.pheromones, blendBuffer.data());
+    }
+}
 
-    for (auto& row : pheromones) {
-        for (auto& value : row) {
-            auto temp = value * (1 - config.p);
+utils::verticies Aco::operator()(size_t startPoint, size_t endPoint)
+{
+    if (config.islands > 1) {
+        return solveIslands({startPoint, endPoint});
+    }
 
-            if (temp >= minPheromoneLevel) {
-                value = temp;
-            } else {
-                value = minPheromoneLevel;
-            }
+    auto workers = threadPool ? threadPool->size() : 1;
+    resetColony(colony, {startPoint, endPoint}, workers, rgen::splitMix64(seed));
+    reportStats.reset();
+    return solve(colony, threadPool.get());
+}
+
+/**
+ * Runs on the thread driving the search, the only writer of
+ * the channel, and copies the route only when it improved.
+ */
+void Aco::publishBest(const Colony& colony)
+{
+    if (!channel || colony.bestPathWeight >= publishedWeight) {
+        return;
+    }
+
+    publishedWeight = colony.bestPathWeight;
+    channel->publish([&colony](RouteSnapshot& snapshot) {
+        snapshot.path.assign(begin(colony.shortestPath), end(colony.shortestPath));
+        snapshot.weight = colony.bestPathWeight;
+        snapshot.iterations = colony.stats.iterations;
+    });
+}
+
+/**
+ * The channel is detached when the solve ends, even by an
+ * exception, so later synchronous queries publish nothing.
+ */
+SolveHandle<RouteSnapshot, utils::verticies> Aco::solveAsync(size_t startPoint,
+                                                             size_t endPoint)
+{
+    auto shared = std::make_shared<SolveChannel<RouteSnapshot>>();
+    channel = shared;
+    publishedWeight = std::numeric_limits<size_t>::max();
+
+    auto result = std::async(std::launch::async, [this, startPoint, endPoint]() {
+        auto detach = ChannelDetach<RouteSnapshot>(channel);
+        return (*this)(startPoint, endPoint);
+    });
+    return {std::move(shared), std::move(result)};
+}
+
+/**
+ * callback gets the stats of the running query every interval
+ * iterations, on the thread that called aco(s, t) or reoptimize().
+ */
+void Aco::setStatsCallback(std::function<void(const SolveStats&)> callback, size_t interval)
+{
+    reportStats.set(std::move(callback), interval);
+}
+
+/**
+ * On an undirected graph both directions of the edge get the new
+ * weight. Only their heuristic entries and the candidate lists of
+ * their rows are refreshed.
+ */
+void Aco::updateWeight(size_t startNode, size_t endNode, size_t weight)
+{
+    auto edge = graph.setWeight(startNode, endNode, weight);
+    heuristic[edge] = 1.0 / std::pow(weight, config.beta);
+    if (!candidateLists.empty()) {
+        sortCandidates(startNode, candidateLists.data() + candidateOffsets[startNode]);
+    }
+
+    if (undirected) {
+        graph.setWeight(endNode, startNode, weight);
+        heuristic[reverseEdges[edge]] = heuristic[edge];
+        if (!candidateLists.empty()) {
+            sortCandidates(endNode, candidateLists.data() + candidateOffsets[endNode]);
         }
     }
 }
 
-utils::verticies Aco::operator()(size_t startPoint, size_t endPoint)
+/**
+ * Resumes the last single query after weight updates. The best path
+ * is re-weighed and the pheromones are clamped to the new limits.
+ * The search runs under config.termination with its stagnation
+ * window cut to warmStartIterations, since a converged colony
+ * recovers from small changes quickly.
+ */
+utils::verticies Aco::reoptimize()
+{
+    if (colony.pheromones.empty()) {
+        throw std::logic_error("No query to re-optimize.");
+    }
+
+    if (!colony.shortestPath.empty()) {
+        colony.bestPathWeight = graph.getPathWeight(colony.shortestPath);
+        updatePheromoneLimits(colony);
+
+        auto minPheromoneLevel = colony.minPheromoneLevel;
+        auto maxPheromoneLevel = colony.maxPheromoneLevel;
+        simd::transform(colony.pheromones.data(), colony.pheromones.size(),
+            [=](auto lanes, auto value) {
+                return lanes.min(lanes.max(value, lanes.set(minPheromoneLevel)),
+                                 lanes.set(maxPheromoneLevel));
+            });
+    }
+
+    // a colony taken over from the island model has a single worker
+    auto pool = colony.antWorkers.size() > 1 ? threadPool.get() : nullptr;
+    auto policy = config.termination;
+    policy.stagnationWindow = std::max<size_t>(config.warmStartIterations, 1);
+    colony.termination = Termination(policy);
+    return solve(colony, pool);
+}
+
+/**
+ * Queries are handed out one at a time from a shared counter, so a
+ * thread that drew short queries picks up more of them. Seeds are
+ * drawn up front in query order, which makes the result of a query
+ * independent of the thread that solved it.
+ */
+std::vector<utils::verticies> Aco::operator()(const std::vector<Query>& queries)
 {
-    this->startPoint = startPoint;
-    this->endPoint = endPoint;
+    auto results = std::vector<utils::verticies>(queries.size());
+    auto seeds = std::vector<std::uint64_t>(queries.size());
+    for (auto& querySeed : seeds) {
+        querySeed = rgen::splitMix64(seed);
+    }
+
+    auto threads = threadPool ? threadPool->size() : 1;
+    batchColonies.resize(threads);
+
+    auto nextQuery = std::atomic<size_t>{0};
+    auto solveQueries = [&](size_t, size_t, size_t workerId) {
+        auto& colony = batchColonies[workerId];
+        for (auto query = nextQuery++; query < queries.size(); query = nextQuery++) {
+            resetColony(colony, queries[query], 1, seeds[query]);
+            results[query] = solve(colony, nullptr, false);
+        }
+    };
 
-    while (!isFinished()) {
-        auto finishedRoutes = constructSolutions();
-        updatePheromoneLevel(finishedRoutes);
-        evaporate();
+    if (threadPool) {
+        threadPool->parallelFor(threads, solveQueries);
+    } else {
+        solveQueries(0, 1, 0);
     }
 
-    return shortestPath;
+    return results;
 }
 
 } // ai
\ No newline at end of file
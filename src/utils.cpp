@@ -6,53 +6,59 @@
  */
 
 #include "utils.hpp"
+#include "simd.hpp"
 
 namespace ai::utils {
 
-value_t spherefn(std::valarray<value_t>& args) {
-    auto sumOfSqueres = [&args](value_t first, value_t second) {
+template <typename T>
+T spherefn(std::valarray<T>& args) {
+    auto sumOfSqueres = [](T first, T second) {
         return first + second * second;
     };
 
-    return std::accumulate(begin(args), end(args), 0.0, sumOfSqueres);
+    return std::accumulate(begin(args), end(args), T{0}, sumOfSqueres);
 }
 
-value_t ackleyfn(std::valarray<value_t>& args) {
-    auto alpha = 20;
-    auto result = -alpha * std::exp(-0.2 * std::sqrt(spherefn(args) / args.size()));
-    auto sumOfCos = [&args](value_t first, value_t second) {
-        return first + std::cos(2 * pi * second);
+template <typename T>
+T ackleyfn(std::valarray<T>& args) {
+    auto alpha = T{20};
+    auto result = -alpha * std::exp(T{-0.2} * std::sqrt(spherefn(args) / args.size()));
+    auto sumOfCos = [](T first, T second) {
+        return first + std::cos(2 * static_cast<T>(pi) * second);
     };
 
-    auto sum = std::accumulate(begin(args), end(args), 0.0, sumOfCos);
-    return result - std::exp(sum / args.size()) + alpha + pi;
+    auto sum = std::accumulate(begin(args), end(args), T{0}, sumOfCos);
+    return result - std::exp(sum / args.size()) + alpha + static_cast<T>(pi);
 }
 
-value_t griewankfn(std::valarray<value_t>& args) {
+template <typename T>
+T griewankfn(std::valarray<T>& args) {
     auto index = 1;
-    auto productOfCos = [&args, &index](value_t first, value_t second) {
+    auto productOfCos = [&index](T first, T second) {
         auto result  = first * std::cos(second / index);
         ++index;
         return result;
     };
 
-    auto product = std::accumulate(begin(args), end(args), 1.0, productOfCos);
+    auto product = std::accumulate(begin(args), end(args), T{1}, productOfCos);
     return spherefn(args) / 4000 - product + 1;
 }
 
-value_t rastriginfn(std::valarray<value_t>& args) {
-    auto result = value_t{10} * args.size();
-    auto sum = [&args](value_t first, value_t second) {
-        return first + (second * second - 10.0 * cos(2.0 * pi * second));
+template <typename T>
+T rastriginfn(std::valarray<T>& args) {
+    auto result = T{10} * args.size();
+    auto sum = [](T first, T second) {
+        return first + (second * second - T{10} * std::cos(2 * static_cast<T>(pi) * second));
     };
 
-    return result + std::accumulate(begin(args), end(args), 0.0, sum);
+    return result + std::accumulate(begin(args), end(args), T{0}, sum);
 }
 
-value_t rosenbrokfn(std::valarray<value_t>& args) {
-    auto resultVect = std::valarray<value_t>(args.size() - 1);
-    auto newVal = [&args](value_t first, value_t second) {
-        return 100.0 * (second - first * first) * (second -first * first)
+template <typename T>
+T rosenbrokfn(std::valarray<T>& args) {
+    auto resultVect = std::valarray<T>(args.size() - 1);
+    auto newVal = [](T first, T second) {
+        return T{100} * (second - first * first) * (second -first * first)
                 + (first - 1) * (first - 1);
     };
 
@@ -61,7 +67,92 @@ value_t rosenbrokfn(std::valarray<value_t>& args) {
     return resultVect.sum();
 }
 
-void prettyPrint(value_t min, std::valarray<value_t>& coordinates, FuncType type) {
+/**
+ * Generic lambdas below receive the lanes type as their first
+ * argument, see simd::reduce().
+ */
+constexpr auto add = [](auto lanes, auto first, auto second) {
+    return lanes.add(first, second);
+};
+
+constexpr auto multiply = [](auto lanes, auto first, auto second) {
+    return lanes.mul(first, second);
+};
+
+template <typename T>
+void sphereBatch(PointsView<T> points, T* results) {
+    auto square = [](auto lanes, auto value) { return lanes.mul(value, value); };
+
+    for (size_t point = 0; point < points.count; ++point) {
+        results[point] = simd::reduce(points.dimensions, T{0}, add, square, points[point]);
+    }
+}
+
+template <typename T>
+void ackleyBatch(PointsView<T> points, T* results) {
+    auto alpha = T{20};
+    auto square = [](auto lanes, auto value) { return lanes.mul(value, value); };
+    auto cosine = [](auto lanes, auto value) {
+        using Lanes = decltype(lanes);
+        return simd::cos<Lanes>(lanes.mul(lanes.set(2 * static_cast<T>(pi)), value));
+    };
+
+    for (size_t point = 0; point < points.count; ++point) {
+        auto sumOfSquares = simd::reduce(points.dimensions, T{0}, add, square, points[point]);
+        auto sumOfCos = simd::reduce(points.dimensions, T{0}, add, cosine, points[point]);
+        results[point] = -alpha * std::exp(T{-0.2} * std::sqrt(sumOfSquares / points.dimensions))
+                         - std::exp(sumOfCos / points.dimensions) + alpha + static_cast<T>(pi);
+    }
+}
+
+template <typename T>
+void griewankBatch(PointsView<T> points, T* results) {
+    auto square = [](auto lanes, auto value) { return lanes.mul(value, value); };
+    auto cosine = [](auto lanes, auto index, auto value) {
+        using Lanes = decltype(lanes);
+        return simd::cos<Lanes>(lanes.div(value, lanes.add(index, lanes.set(T{1}))));
+    };
+
+    for (size_t point = 0; point < points.count; ++point) {
+        auto sum = simd::reduce(points.dimensions, T{0}, add, square, points[point]);
+        auto product = simd::reduceIndexed(points.dimensions, T{1}, multiply, cosine,
+                                           points[point]);
+        results[point] = sum / 4000 - product + 1;
+    }
+}
+
+template <typename T>
+void rastriginBatch(PointsView<T> points, T* results) {
+    auto term = [](auto lanes, auto value) {
+        using Lanes = decltype(lanes);
+        auto cosine = simd::cos<Lanes>(lanes.mul(lanes.set(2 * static_cast<T>(pi)), value));
+        return lanes.sub(lanes.mul(value, value), lanes.mul(lanes.set(T{10}), cosine));
+    };
+
+    for (size_t point = 0; point < points.count; ++point) {
+        results[point] = T{10} * points.dimensions
+                         + simd::reduce(points.dimensions, T{0}, add, term, points[point]);
+    }
+}
+
+template <typename T>
+void rosenbrokBatch(PointsView<T> points, T* results) {
+    auto term = [](auto lanes, auto first, auto second) {
+        auto one = lanes.set(T{1});
+        auto valley = lanes.sub(second, lanes.mul(first, first));
+        auto slope = lanes.sub(first, one);
+        return lanes.add(lanes.mul(lanes.set(T{100}), lanes.mul(valley, valley)),
+                         lanes.mul(slope, slope));
+    };
+
+    for (size_t point = 0; point < points.count; ++point) {
+        auto row = points[point];
+        results[point] = simd::reduce(points.dimensions - 1, T{0}, add, term, row, row + 1);
+    }
+}
+
+template <typename T>
+void prettyPrint(T min, std::valarray<T>& coordinates, FuncType type) {
     auto testName = std::string{};
     switch (type) {
         case FuncType::Sphere: testName = "TEST FOR A SPERE FUNCTION"; break;
@@ -77,4 +168,23 @@ void prettyPrint(value_t min, std::valarray<value_t>& coordinates, FuncType type
     print(coordinates);
 }
 
+#define AI_INSTANTIATE_FUNCTIONS(T) \
+    template T spherefn<T>(std::valarray<T>&); \
+    template T ackleyfn<T>(std::valarray<T>&); \
+    template T griewankfn<T>(std::valarray<T>&); \
+    template T rastriginfn<T>(std::valarray<T>&); \
+    template T rosenbrokfn<T>(std::valarray<T>&); \
+    template void sphereBatch<T>(PointsView<T>, T*); \
+    template void ackleyBatch<T>(PointsView<T>, T*); \
+    template void griewankBatch<T>(PointsView<T>, T*); \
+    template void rastriginBatch<T>(PointsView<T>, T*); \
+    template void rosenbrokBatch<T>(PointsView<T>, T*); \
+    template void prettyPrint<T>(T, std::valarray<T>&, FuncType);
+
+AI_INSTANTIATE_FUNCTIONS(float)
+AI_INSTANTIATE_FUNCTIONS(double)
+AI_INSTANTIATE_FUNCTIONS(long double)
+
+#undef AI_INSTANTIATE_FUNCTIONS
+
 } // utils